@@ -0,0 +1,142 @@
+#include <Fission/Core/Layer.hh>
+#include <Fission/Base/Memory.hpp>
+#include <cstring>
+
+#define ESCAPE 0x1b
+
+__FISSION_BEGIN__
+
+void Console_Buffer::create(u64 _capacity, u64 max_lines) {
+	// cache line sized, allocations must be a multiple of the alignment
+	capacity = (max(_capacity, FS_KILOBYTES(1)) + 63) & ~u64(63);
+	data = (c8*)FISSION_TAGGED_ALLOC(capacity, console);
+
+	line_capacity = 64;
+	while (line_capacity < max_lines) line_capacity <<= 1;
+	lines = (Line*)FISSION_TAGGED_ALLOC(line_capacity * sizeof(Line), console);
+
+	first_line = 0;
+	end_line   = 0;
+	clear();
+}
+
+void Console_Buffer::destroy() {
+	FISSION_DEFAULT_FREE(lines);
+	FISSION_DEFAULT_FREE(data);
+	lines = nullptr;
+	data  = nullptr;
+}
+
+void Console_Buffer::clear() {
+	color_state = {};
+	color_bytes = 0;
+
+	// positions and line indices keep counting up, so anything
+	//  remembered about old lines can never match a new line
+	u64 start = 0;
+	if (end_line) {
+		auto& open = line(end_line - 1);
+		start = open.start + open.count;
+	}
+
+	first_line = end_line;
+	line(end_line++) = Line{.start = start, .count = 0, .rows = 0, .row_start = 0, .color = color_state.color, .using_color = false, .severity = 0};
+}
+
+void Console_Buffer::new_line() {
+	auto& open = line(end_line - 1);
+	u64 start = open.start + open.count;
+
+	// out of lines, forget the oldest one
+	if (line_count() == line_capacity) ++first_line;
+
+	line(end_line++) = Line{
+		.start       = start,
+		.count       = 0,
+		.rows        = 0,
+		.row_start   = 0,
+		.color       = color_state.color,
+		.using_color = color_state.using_color,
+		.severity    = 0,
+	};
+}
+
+void Console_Buffer::make_room(Line& open, u64 added_count) {
+	u64 offset = open.start % capacity;
+	u64 end    = open.start + open.count + added_count;
+
+	// line would go past the end of the buffer, continue it from the start
+	bool move_to_front = offset + open.count + added_count > capacity;
+	if (move_to_front) {
+		end = open.start - offset + capacity + open.count + added_count;
+	}
+
+	// drop every line that would be written over
+	while (first_line < end_line - 1 && line(first_line).start + capacity < end) ++first_line;
+
+	if (move_to_front) {
+		memmove(data, data + offset, open.count);
+		open.start += capacity - offset;
+	}
+}
+
+void Console_Buffer::write(c8 const* text, u64 count, u8 severity) {
+	if (count == 0) return;
+
+	auto& open = line(end_line - 1);
+	make_room(open, count);
+
+	memcpy(data + open.start % capacity + open.count, text, count);
+	open.count += (u32)count;
+	open.severity = max(open.severity, severity);
+
+	// open line has changed, needs to be laid out again
+	open.rows = 0;
+}
+
+void Console_Buffer::append(string text, u8 severity) {
+	// lines can only be so long, longer lines are split up so they always fit
+	u64 const max_line_length = capacity / 4;
+
+	u64 begin = 0;
+	u64 open_count = line(end_line - 1).count;
+
+	FS_FOR(text.count) {
+		c8 c = text.data[i];
+
+		// color code bytes can be anything, even a newline
+		if (color_bytes) {
+			switch (color_bytes--) {
+			case 3: color_state.color.r = c; break;
+			case 2: color_state.color.g = c; break;
+			case 1: color_state.color.b = c; break;
+			}
+			continue;
+		}
+
+		if (open_count + (i - begin) >= max_line_length) {
+			write(text.data + begin, i - begin, severity);
+			new_line();
+			begin = i;
+			open_count = 0;
+		}
+
+		if (c == ESCAPE) {
+			if (color_state.using_color) color_state.color = colors::White;
+			else                         color_bytes = 3;
+			color_state.using_color = !color_state.using_color;
+			continue;
+		}
+
+		if (c == '\n') {
+			write(text.data + begin, i - begin, severity);
+			new_line();
+			begin = i + 1;
+			open_count = 0;
+		}
+	}
+
+	write(text.data + begin, text.count - begin, severity);
+}
+
+__FISSION_END__
@@ -1,7 +1,8 @@
 ﻿#include <Fission/Core/Engine.hh>
 #include <Fission/Core/Input/Keys.hh>
 #include <Fission/Core/Console.hh>
-#include <unordered_map>
+#include <Fission/Base/Memory.hpp>
+#include <atomic>
 
 extern fs::Engine engine;
 
@@ -13,126 +14,350 @@ __FISSION_BEGIN__
 // Public facing interface
 namespace console {
 
-	// std::string because I am lazy
-	static std::unordered_map<std::string, console_callback_proc> callback_table;
-	static std::mutex access_mutex;
+	// Command registry, names are interned into a fixed pool and commands are
+	//  kept sorted by name. Looking up a command never allocates, and all commands
+	//  starting with a prefix are next to each other (used for tab completion).
+	struct Command {
+		string                name; // points into `name_pool`
+		console_callback_proc proc;
+	};
+
+	static constexpr u32 max_command_count = 256;
+	static constexpr u64 name_pool_size    = FS_KILOBYTES(4);
+
+	static Command commands[max_command_count];
+	static u32     command_count = 0;
+	static c8      name_pool[name_pool_size];
+	static u64     name_pool_used = 0;
+
+	static int compare(string a, string b) {
+		int c = memcmp(a.data, b.data, min(a.count, b.count));
+		if (c != 0) return c;
+		return (a.count < b.count) ? -1 : (a.count > b.count);
+	}
 
-	void register_command(string name, console_callback_proc proc) {
-		callback_table.emplace(std::string(name.str()), proc);
+	// index of the first command with a name >= `name`
+	static u32 lower_bound(string name) {
+		u32 first = 0, count = command_count;
+		while (count > 0) {
+			u32 step = count / 2;
+			if (compare(commands[first + step].name, name) < 0) {
+				first += step + 1;
+				count -= step + 1;
+			}
+			else count = step;
+		}
+		return first;
 	}
-	void unregister_command(string name) {
-		callback_table.erase(std::string(name.str()));
+
+	static console_callback_proc find_command(string name) {
+		u32 index = lower_bound(name);
+		if (index < command_count && compare(commands[index].name, name) == 0)
+			return commands[index].proc;
+		return nullptr;
 	}
 
-	void clear() {
-		std::scoped_lock lock{access_mutex};
-		engine.console_layer.buffer_view.count = 0;
+	// range of commands that start with `prefix`, [first, last)
+	static void find_commands_with_prefix(string prefix, u32& first, u32& last) {
+		first = lower_bound(prefix);
+		last  = first;
+		while (last < command_count
+			&& commands[last].name.count >= prefix.count
+			&& memcmp(commands[last].name.data, prefix.data, prefix.count) == 0) ++last;
 	}
 
-	void println(string text) {
-		std::scoped_lock lock{access_mutex};
-		u64 space_needed = text.count + 1;
+	// unregistered names leave holes in the pool, only when it fills up do they get removed
+	static void compact_name_pool() {
+		static c8 temp[name_pool_size];
+		u64 used = 0;
+		FS_FOR(command_count) {
+			auto& name = commands[i].name;
+			memcpy(temp + used, name.data, name.count);
+			name.data = name_pool + used;
+			used += name.count;
+		}
+		memcpy(name_pool, temp, used);
+		name_pool_used = used;
+	}
+
+	static void list_commands(string prefix) {
+		u32 first, last;
+		find_commands_with_prefix(prefix, first, last);
+		for (u32 i = first; i < last; ++i) {
+			print(FS_str("  "));
+			println(commands[i].name);
+		}
+	}
+
+	void register_command(string name, console_callback_proc proc) {
+		u32 index = lower_bound(name);
+
+		// already registered, replace it
+		if (index < command_count && compare(commands[index].name, name) == 0) {
+			commands[index].proc = proc;
+			return;
+		}
+
+		if (name_pool_used + name.count > name_pool_size) compact_name_pool();
 
-		if (space_needed >= Console_Layer::default_buffer_size - 1)
-			return; // silent fail... too long didn't read
+		if (command_count == max_command_count || name_pool_used + name.count > name_pool_size) {
+			char temp[128];
+			println("failed to register command \"%.*s\": too many commands"_fmt(temp, (int)name.count, name.data), colors::Red);
+			return;
+		}
 
-		engine.console_layer._reserve_space_for(space_needed);
-		auto& console_view = engine.console_layer.buffer_view;
+		c8* interned = name_pool + name_pool_used;
+		memcpy(interned, name.data, name.count);
+		name_pool_used += name.count;
 
-		memcpy(console_view.data + console_view.count, text.data, text.count);
-		console_view.count += text.count;
-		console_view.data[console_view.count++] = '\n';
+		memmove(commands + index + 1, commands + index, (command_count - index) * sizeof(Command));
+		commands[index] = Command{.name = {.count = name.count, .data = interned}, .proc = proc};
+		++command_count;
 	}
+	void unregister_command(string name) {
+		u32 index = lower_bound(name);
+		if (index == command_count || compare(commands[index].name, name) != 0) return;
 
-	void println(string text, rgb8 color) {
-		std::scoped_lock lock{access_mutex};
-		u64 space_needed = text.count + 1 + 4 + 1;
+		--command_count;
+		memmove(commands + index, commands + index + 1, (command_count - index) * sizeof(Command));
+	}
 
-		if (space_needed >= Console_Layer::default_buffer_size - 1)
-			return; // silent fail... too long didn't read
+	// Every thread that logs gets its own queue (single producer, single consumer),
+	//  writing a message never blocks, and never waits on another thread.
+	// The console thread drains every queue once per frame.
+	//
+	// Queues live for as long as the process, threads may still be logging
+	//  while the engine is shutting down. Queues of threads that have exited get reused.
+	struct alignas(64) Log_Queue {
+		static constexpr u64 size = FS_KILOBYTES(64); // power of 2
+
+		enum State: u32 { owned, abandoned, free };
+
+		// every message is a header followed by `header & count_mask` bytes
+		static constexpr u32 clear_message  = 1u << 31;
+		static constexpr u32 severity_shift = 29; // 2 bits
+		static constexpr u32 count_mask     = (1u << severity_shift) - 1;
+
+		alignas(64) std::atomic<u64> write   = 0; // only changed by the producer
+		alignas(64) std::atomic<u64> read    = 0; // only changed by the consumer
+		std::atomic<u32>             dropped = 0; // messages that did not fit
+		std::atomic<u32>             state   = owned;
+		Log_Queue*                   next    = nullptr;
+
+		c8 data[size];
+
+		void copy_in(u64 position, void const* src, u64 count) {
+			u64 offset = position & (size - 1);
+			u64 first  = min(count, size - offset);
+			memcpy(data + offset, src, first);
+			memcpy(data, (c8 const*)src + first, count - first);
+		}
+		void copy_out(u64 position, void* dst, u64 count) const {
+			u64 offset = position & (size - 1);
+			u64 first  = min(count, size - offset);
+			memcpy(dst, data + offset, first);
+			memcpy((c8*)dst + first, data, count - first);
+		}
+	};
 
-		engine.console_layer._reserve_space_for(space_needed);
-		auto& console_view = engine.console_layer.buffer_view;
+	static std::atomic<Log_Queue*> log_queues = nullptr;
 
-		c8 color_code[4] = { ESCAPE, color.r, color.g, color.b };
-		memcpy(console_view.data + console_view.count, color_code, sizeof(color_code));
-		console_view.count += sizeof(color_code);
+	// messages from threads that could not get a queue (out of memory)
+	static std::atomic<u32> dropped_without_queue = 0;
+
+	struct Thread_Log_Queue {
+		Log_Queue* queue = nullptr;
+		~Thread_Log_Queue() {
+			if (queue) queue->state.store(Log_Queue::abandoned, std::memory_order_release);
+		}
+	};
+	static thread_local Thread_Log_Queue thread_queue;
+
+	// the console thread writes straight into the console buffer
+	static thread_local bool is_console_thread = false;
+
+	static Log_Queue* get_log_queue() {
+		if (thread_queue.queue) return thread_queue.queue;
+
+		// try to reuse a queue from a thread that has exited
+		for (auto q = log_queues.load(std::memory_order_acquire); q; q = q->next) {
+			u32 expected = Log_Queue::free;
+			if (q->state.compare_exchange_strong(expected, Log_Queue::owned, std::memory_order_acquire))
+				return thread_queue.queue = q;
+		}
+
+		auto memory = FISSION_TAGGED_ALLOC(sizeof(Log_Queue), process);
+		if (!memory) return nullptr; // try again with the next message
 
-		memcpy(console_view.data + console_view.count, text.data, text.count);
-		console_view.count += text.count;
+		auto q = new (memory) Log_Queue;
+		q->next = log_queues.load(std::memory_order_relaxed);
+		while (!log_queues.compare_exchange_weak(q->next, q, std::memory_order_release, std::memory_order_relaxed));
 
-		console_view.data[console_view.count++] = ESCAPE;
-		console_view.data[console_view.count++] = '\n';
+		return thread_queue.queue = q;
 	}
 
-	void print(string text) {
-		std::scoped_lock lock{access_mutex};
-		if (text.count >= Console_Layer::default_buffer_size - 1)
-			return; // silent fail... too long didn't read
+	// push one message made up of `count` pieces of text
+	static void push_message(u32 flags, string const* parts, u32 count) {
+		auto q = get_log_queue();
+		if (!q) {
+			dropped_without_queue.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		u64 text_count = 0;
+		FS_FOR(count) text_count += parts[i].count;
 
-		engine.console_layer._reserve_space_for(text.count);
-		auto& console_view = engine.console_layer.buffer_view;
+		// too big to ever fit
+		if (text_count > Log_Queue::size / 2) {
+			q->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
 
-		memcpy(console_view.data + console_view.count, text.data, text.count);
-		console_view.count += text.count;
+		u32 header = u32(text_count) | flags;
+		u64 write  = q->write.load(std::memory_order_relaxed);
+		u64 read   = q->read.load(std::memory_order_acquire);
+
+		if (Log_Queue::size - (write - read) < sizeof(header) + text_count) {
+			q->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		u64 position = write;
+		q->copy_in(position, &header, sizeof(header));
+		position += sizeof(header);
+
+		FS_FOR(count) {
+			q->copy_in(position, parts[i].data, parts[i].count);
+			position += parts[i].count;
+		}
+
+		q->write.store(position, std::memory_order_release);
 	}
-	void print(string text, rgb8 color) {
-		std::scoped_lock lock{access_mutex};
-		u64 space_needed = text.count + 4 + 1;
 
-		if (space_needed >= Console_Layer::default_buffer_size - 1)
-			return; // silent fail... too long didn't read
+	static void write(string const* parts, u32 count, u8 severity = severity::info) {
+		if (is_console_thread) {
+			FS_FOR(count) engine.console_layer.write(parts[i], severity);
+			return;
+		}
+		push_message(u32(severity) << Log_Queue::severity_shift, parts, count);
+	}
+
+	void prepare_thread() {
+		if (!is_console_thread) (void)get_log_queue();
+	}
 
-		engine.console_layer._reserve_space_for(space_needed);
-		auto& console_view = engine.console_layer.buffer_view;
+	void log(severity::Type severity, string text) {
+		static constexpr rgb8 severity_colors[] = { colors::White, colors::Yellow, colors::Red };
 
+		rgb8 color = severity_colors[min((u32)severity, 2u)];
 		c8 color_code[4] = { ESCAPE, color.r, color.g, color.b };
-		memcpy(console_view.data + console_view.count, color_code, 4);
-		console_view.count += 4;
+		string parts[] = { FS_str_make(color_code, sizeof(color_code)), text, FS_str("\x1b\n") };
+		write(parts, std::size(parts), severity);
+	}
+
+	void clear() {
+		if (is_console_thread) return engine.console_layer.buffer.clear();
+		push_message(Log_Queue::clear_message, nullptr, 0);
+	}
+
+	void println(string text) {
+		string parts[] = { text, FS_str("\n") };
+		write(parts, std::size(parts));
+	}
 
-		memcpy(console_view.data + console_view.count, text.data, text.count);
-		console_view.count += text.count;
+	void println(string text, rgb8 color) {
+		c8 color_code[4] = { ESCAPE, color.r, color.g, color.b };
+		string parts[] = { FS_str_make(color_code, sizeof(color_code)), text, FS_str("\x1b\n") };
+		write(parts, std::size(parts));
+	}
 
-		console_view.data[console_view.count++] = ESCAPE;
+	void print(string text) {
+		write(&text, 1);
+	}
+	void print(string text, rgb8 color) {
+		c8 color_code[4] = { ESCAPE, color.r, color.g, color.b };
+		string parts[] = { FS_str_make(color_code, sizeof(color_code)), text, FS_str("\x1b") };
+		write(parts, std::size(parts));
 	}
 
 }
 //////////////////////////////////////////////////////////////////////////////
 
-void Console_Layer::_reserve_space_for(u64 added_count) {
-	if (buffer_view.count + added_count < buffer_capacity) return;
+void Console_Layer::drain_log_queues() {
+	using console::Log_Queue;
 
-	auto new_start = buffer_view.data + minimum_buffer_delete_count;
-	auto end       = buffer_view.data + maximum_buffer_delete_count;
+	for (auto q = console::log_queues.load(std::memory_order_acquire); q; q = q->next) {
+		// producer may be gone, it has to be checked before we look at what is in the queue
+		bool abandoned = q->state.load(std::memory_order_acquire) == Log_Queue::abandoned;
 
-	if (added_count > maximum_buffer_delete_count) {
-		new_start = buffer_view.data + added_count;
-	}
-	else {
-		while (new_start < end) {
-			if (*new_start == '\n') {
-				++new_start;
-				break;
+		u64 read  = q->read.load(std::memory_order_relaxed);
+		u64 write = q->write.load(std::memory_order_acquire);
+
+		while (read < write) {
+			u32 header;
+			q->copy_out(read, &header, sizeof(header));
+			read += sizeof(header);
+
+			if (header & Log_Queue::clear_message) {
+				buffer.clear();
+				continue;
 			}
-			++new_start;
+
+			// message can wrap around the end of the queue
+			u64 count    = header & Log_Queue::count_mask;
+			u8  severity = u8((header >> Log_Queue::severity_shift) & 3);
+			u64 offset   = read & (Log_Queue::size - 1);
+			u64 first    = min(count, Log_Queue::size - offset);
+			write(string{.count = first, .data = q->data + offset}, severity);
+			write(string{.count = count - first, .data = q->data}, severity);
+			read += count;
+		}
+
+		q->read.store(read, std::memory_order_release);
+
+		if (u32 dropped = q->dropped.exchange(0, std::memory_order_relaxed)) {
+			char temp[64];
+			console::println("%u console messages dropped (queue full)"_fmt(temp, dropped), colors::Yellow);
 		}
-		new_start = std::min(new_start, end);
+
+		if (abandoned) q->state.store(Log_Queue::free, std::memory_order_release);
 	}
-	
-	buffer_view.count = (buffer_view.data + buffer_view.count) - new_start;
-	memmove(buffer_view.data, new_start, buffer_view.count);
+
+	if (u32 dropped = console::dropped_without_queue.exchange(0, std::memory_order_relaxed)) {
+		char temp[64];
+		console::println("%u console messages dropped (no memory for a queue)"_fmt(temp, dropped), colors::Yellow);
+	}
+
+	log_file.flush();
 }
 
-void Console_Layer::setup_console_api() {
+void Console_Layer::write(string text, u8 severity) {
+	buffer.append(text, severity);
+	log_file.write(text);
+	if (capture) capture->append((char const*)text.data, text.count);
+}
+
+void Console_Layer::setup_console_api(Defaults const& defaults) {
 	input.count = 2;
 	input.data  = input_buffer;
 	memset(input_buffer, 0, sizeof(input_buffer));
 	input_buffer[0] = '>';
 	input_buffer[1] = ' ';
 
-	buffer_capacity = default_buffer_size;
-	buffer_view.data = (c8*)FISSION_DEFAULT_ALLOC(buffer_capacity);
-	buffer_view.count = 0;
+	// assume lines are ~32 characters on average
+	buffer.create(defaults.console_history, defaults.console_history / 32);
+	layout_width    = 0.0f;
+	layout_end_line = 0;
+
+	if (!defaults.console_log_file.is_empty())
+		log_file.open(defaults.console_log_file);
+
+	if (!defaults.remote_console.is_empty())
+		remote.start(defaults.remote_console);
+
+	// anything logged before now is still in a queue
+	drain_log_queues();
+	console::is_console_thread = true;
 
 	command_history_buffer.reserve(256);
 	command_history_ends.reserve(32);
@@ -145,11 +370,86 @@ void Console_Layer::setup_console_api() {
 	} {
 		auto callback = [](string input) { console::println(input); };
 		console::register_command(FS_str("echo"), callback);
+	} {
+		auto callback = [](string prefix) { console::list_commands(prefix); };
+		console::register_command(FS_str("help"), callback);
+	} {
+		// log_file <path> -> mirror console output to <path>
+		// log_file        -> stop
+		auto callback = [](string path) {
+			auto& log_file = engine.console_layer.log_file;
+			if (path.is_empty()) {
+				log_file.close();
+				console::println(FS_str("log file closed"));
+				return;
+			}
+			if (log_file.open(path)) {
+				console::print(FS_str("logging to "));
+				console::println(path);
+			}
+			else {
+				console::print(FS_str("failed to open log file: "), colors::Red);
+				console::println(path, colors::Red);
+			}
+		};
+		console::register_command(FS_str("log_file"), callback);
+	} {
+		// remote <socket path> -> accept commands from other processes
+		// remote               -> stop
+		auto callback = [](string path) {
+			auto& remote = engine.console_layer.remote;
+			if (path.is_empty()) {
+				remote.stop();
+				console::println(FS_str("remote console stopped"));
+				return;
+			}
+			if (remote.start(path)) {
+				console::print(FS_str("remote console listening on "));
+				console::println(path);
+			}
+			else {
+				console::print(FS_str("failed to start remote console on: "), colors::Red);
+				console::println(path, colors::Red);
+			}
+		};
+		console::register_command(FS_str("remote"), callback);
+	} {
+		// find <text> -> only show lines containing <text>
+		// find        -> show every line again
+		auto callback = [](string text) {
+			auto& layer = engine.console_layer;
+			layer.set_filter(layer.filter.min_severity, text);
+
+			// the echo of this command would always be the first match
+			layer.filter.skip_line = layer.command_echo_line;
+		};
+		console::register_command(FS_str("find"), callback);
+	} {
+		// filter <info|warning|error|off> -> only show lines of at least this severity
+		auto callback = [](string level) {
+			auto& layer = engine.console_layer;
+			u8 severity;
+			if      (level == "warning") severity = console::severity::warning;
+			else if (level == "error")   severity = console::severity::error;
+			else if (level == "info" || level == "off" || level.is_empty()) severity = console::severity::info;
+			else {
+				console::println(FS_str("usage: filter <info|warning|error|off>"), colors::Red);
+				return;
+			}
+			layer.set_filter(severity, FS_str_std(layer.filter.pattern));
+		};
+		console::register_command(FS_str("filter"), callback);
 	}
 }
 
 void Console_Layer::destroy() {
-	FISSION_DEFAULT_FREE(buffer_view.data);
+	remote.stop();
+
+	// make sure everything makes it into the log file
+	drain_log_queues();
+	log_file.close();
+
+	buffer.destroy();
 }
 
 string find_command_action(string s) {
@@ -188,6 +488,36 @@ string find_command_arguments(string s) {
 	return string{.count = s.count - cursor, .data = s.data + cursor};
 }
 
+void console::execute(string command, bool echo) {
+	if (!echo) return execute_echoed(command, ~0ull);
+
+	console::print(FS_str("> "));
+	console::println(command);
+
+	// only the console thread writes straight into the buffer, the echo is the last closed line
+	auto const& buffer = engine.console_layer.buffer;
+	execute_echoed(command, is_console_thread ? buffer.end_line - 2 : ~0ull);
+}
+
+void console::execute_echoed(string command, u64 echo_line) {
+	auto& layer = engine.console_layer;
+	u64 outer_echo_line = layer.command_echo_line; // commands can run commands (`exec`)
+	layer.command_echo_line = echo_line;
+
+	auto action = find_command_action(command);
+
+	if (auto proc = console::find_command(action)) {
+	// Execute Command
+		proc(find_command_arguments(command));
+	} else {
+		console::print(FS_str("\x1b\xFF\x25\x25unknown command: "));
+		console::print(action);
+		console::print(FS_str("\x1b\n"));
+	}
+
+	layer.command_echo_line = outer_echo_line;
+}
+
 // For Pasting from clipboard
 bool acceptable_character(char c) {
 	switch (c)
@@ -239,6 +569,20 @@ void Console_Layer::handle_character_input(Event::Character_Input in) {
 #endif // FISSION_PLATFORM_
 	}
 
+	break; case '\t': {
+		// copy command into input
+		if (current_command != -1) {
+			auto cmd = command_from_history();
+
+			memcpy(input.data + 2, cmd.data, cmd.count);
+
+			input.count = cmd.count + 2;
+			input_cursor = (int)input.count;
+			current_command = -1;
+		}
+
+		complete_command();
+	}
 	break; case '\b': {
 		// copy command into input
 		if (current_command != -1) {
@@ -266,20 +610,7 @@ void Console_Layer::handle_character_input(Event::Character_Input in) {
 
 		auto command = (current_command == -1)? input.substr(2) : command_from_history();
 
-		console::print(FS_str("> "));
-		console::println(command);
-
-		auto action = find_command_action(command);
-
-		auto it = console::callback_table.find(std::string(action.str()));
-		if (it != console::callback_table.end()) {
-		// Execute Command
-			it->second(find_command_arguments(command));
-		} else {
-			console::print(FS_str("\x1b\xFF\x25\x25unknown command: "));
-			console::print(action);
-			console::print(FS_str("\x1b\n"));
-		}
+		console::execute(command);
 
 		// copy command to command history buffer
 		FS_FOR(command.count) {
@@ -324,6 +655,47 @@ void Console_Layer::handle_character_input(Event::Character_Input in) {
 	}
 }
 
+void Console_Layer::complete_command() {
+	auto typed = input.substr(2, input_cursor - 2);
+
+	// only command names get completed
+	FS_FOR(typed.count) if (typed.data[i] == ' ') return;
+
+	u32 first, last;
+	console::find_commands_with_prefix(typed, first, last);
+	if (first == last) return;
+
+	// commands are sorted, what the first and last match share, every match shares
+	string a = console::commands[first].name;
+	string b = console::commands[last - 1].name;
+	u64 common = typed.count;
+	while (common < a.count && common < b.count && a.data[common] == b.data[common]) ++common;
+
+	// nothing more to complete, show what the options are
+	if (common == typed.count && last - first > 1) {
+		console::print(FS_str("> "));
+		console::println(typed);
+		console::list_commands(typed);
+		return;
+	}
+
+	c8 rest[sizeof(input_buffer)];
+	u64 rest_count = input.count - input_cursor;
+	memcpy(rest, input.data + input_cursor, rest_count);
+
+	u64 count = min(common, sizeof(input_buffer) - 3 - rest_count);
+	memcpy(input.data + 2, a.data, count);
+	input_cursor = int(2 + count);
+
+	// only one match, ready for arguments
+	if (last - first == 1 && input_cursor + rest_count < 71) {
+		input.data[input_cursor++] = ' ';
+	}
+
+	memcpy(input.data + input_cursor, rest, rest_count);
+	input.count = input_cursor + rest_count;
+}
+
 string Console_Layer::command_from_history()
 {
 	string command;
@@ -406,25 +778,6 @@ void Console_Layer::handle_events(std::vector<Event>& events) {
 //	engine.debug_layer.add("buffer_view_offset = %i", buffer_view_offset);
 }
 
-// "hello\nweh\n"
-//  ↑         ↑
-//  start     cursor
-// OUTPUT == "weh"
-string get_string(c8 const* cursor, c8 const* start) {
-	c8 const* end = cursor;
-
-	// subtract until we land on a newline
-	while (--cursor > start && *cursor != '\n');
-
-	// go to the character after the newline
-	if(*cursor == '\n') ++cursor;
-	
-	// no progress was made, return empty string
-	if (cursor == end) return string{.count = 0, .data = (c8*)cursor};
-	
-	return string{.count = u64(end - cursor), .data = (c8*)cursor};
-}
-
 struct Color_Info {
 	rgb8 color = colors::White;
 	bool using_color = false;
@@ -432,7 +785,7 @@ struct Color_Info {
 
 void add_string(Textured_Renderer_2D& r, Color_Info& info, string str, v2f32 pos) {
 	fs::Glyph const* glyph;
-	info = {};
+	bool const subpixel = engine.fonts.console.subpixel_variants > 1;
 
 	FS_FOR(str.count) {
 		u32 c = str.data[i];
@@ -442,7 +795,7 @@ void add_string(Textured_Renderer_2D& r, Color_Info& info, string str, v2f32 pos
 			if (info.using_color) {
 				info.color = colors::White;
 			} else {
-				if(i + 2 >= str.count) // "not enough bytes for color value [add_string]"
+				if(i + 3 >= str.count) // "not enough bytes for color value [add_string]"
 					return; // silent fail
 				u8 red   = str.data[++i];
 				u8 green = str.data[++i];
@@ -453,71 +806,260 @@ void add_string(Textured_Renderer_2D& r, Color_Info& info, string str, v2f32 pos
 			continue;
 		}
 		else if (c == '\t') {
-			glyph = engine.fonts.console.lookup(' ');
+			glyph = engine.fonts.console.table.lookup(' ');
 			pos.x += glyph->advance * 4;
 			continue;
 		}
 
-		glyph = engine.fonts.console.lookup(c);
+		glyph = engine.fonts.console.table.lookup(c);
 
 		if (c != ' ') {
-			r.add_glyph(glyph, pos, 1.0f, color(info.color));
+			if (subpixel) r.add_glyph_subpixel(glyph, pos, color(info.color));
+			else          r.add_glyph(glyph, pos, 1.0f, color(info.color));
 		}
 
 		pos.x += glyph->advance;
 	}
 }
 
-// TODO: refactor console so that it draws from top to bottom (to fix colors on multiple lines)
+// index of the first `pattern` in `text`, or `text.count` when there is none.
+//  memchr for the first character, then compare the rest
+static u64 find_text(string text, string pattern) {
+	if (pattern.count == 0) return 0;
+	if (pattern.count > text.count) return text.count;
+
+	c8 const* p   = text.data;
+	c8 const* end = text.data + (text.count - pattern.count + 1);
+	while (p < end) {
+		p = (c8 const*)memchr(p, pattern.data[0], end - p);
+		if (!p) break;
+		if (memcmp(p + 1, pattern.data + 1, pattern.count - 1) == 0) return u64(p - text.data);
+		++p;
+	}
+	return text.count;
+}
+
+void Console_Layer::set_filter(u8 min_severity, string pattern) {
+	filter.min_severity = min_severity;
+	filter.pattern      = std::string(pattern.str());
+	filter.matches.clear();
+	filter.scanned_end  = 0;
+	filter.skip_line    = ~0ull;
+	++filter.generation;
+	buffer_view_offset  = 0;
+}
+
+bool Console_Layer::line_matches(Console_Buffer::Line const& line) const {
+	if (line.severity < filter.min_severity) return false;
+	auto text = buffer.text(line);
+	return filter.pattern.empty() || find_text(text, FS_str_std(filter.pattern)) != text.count;
+}
+
+void Console_Layer::update_filter() {
+	// forget lines that are no longer in the buffer
+	while (!filter.matches.empty() && filter.matches.front() < buffer.first_line)
+		filter.matches.pop_front();
+
+	u64 budget = filter_scan_budget;
+	u64 index  = max(filter.scanned_end, buffer.first_line);
+
+	// the open line can still change, it is never stored
+	for (; index < buffer.end_line - 1 && budget; ++index) {
+		auto const& line = buffer.line(index);
+		if (index != filter.skip_line && line_matches(line)) filter.matches.push_back(index);
+		budget -= min(budget, (u64)line.count + 1);
+	}
+	filter.scanned_end = index;
+}
+
+void Console_Layer::draw_filtered_lines(Textured_Renderer_2D& r, float top, float ystride) {
+	auto const& open = buffer.line(buffer.end_line - 1);
+	bool open_matches = open.rows && line_matches(open);
+
+	Visible_Key key = {
+		.bottom_row = (u64)buffer_view_offset,
+		.first_line = buffer.first_line,
+		.end_line   = buffer.end_line,
+		.open_count = open.count,
+		.max_rows   = (top >= -ystride) ? u32((top + ystride) / ystride) + 1 : 0,
+		.width      = layout_width,
+		.filter     = (u64(filter.generation) << 32) | (filter.matches.size() + open_matches),
+	};
+
+	if (!(key == visible_key)) {
+		visible_key = key;
+		visible_rows.clear();
+
+		// walk back through the matches, [0, match_count) where the last one may be the open line
+		u64 match_count = filter.matches.size() + open_matches;
+		u64 m;
+
+		for (;;) {
+			s64 skip = buffer_view_offset;
+			m = match_count;
+
+			while (m > 0 && visible_rows.size() < key.max_rows) {
+				--m;
+				u64 index = (m == filter.matches.size()) ? buffer.end_line - 1 : filter.matches[m];
+				auto const& line = buffer.line(index);
+
+				if (skip >= (s64)line.rows) {
+					skip -= line.rows;
+					continue;
+				}
+
+				layout.layout(buffer.text(line), {line.color, line.using_color});
+				for (s64 i = min((s64)line.rows - 1 - skip, (s64)layout.lines.size() - 1); i >= 0 && visible_rows.size() < key.max_rows; --i)
+					visible_rows.emplace_back(Visible_Row{index, layout.lines[i]});
+				skip = 0;
+			}
+
+			// scrolled past the oldest match, stop at the oldest one and try again
+			if (!visible_rows.empty() || key.max_rows == 0 || buffer_view_offset == 0) break;
+			buffer_view_offset = max(buffer_view_offset - (int)skip - 1, 0);
+			key.bottom_row = buffer_view_offset;
+			visible_key = key;
+		}
+
+		visible_at_end = (m == 0);
+	}
+
+	if (visible_at_end)
+		flags |=  layer::console_end_of_buffer;
+	else
+		flags &=~ layer::console_end_of_buffer;
+
+	auto pattern = FS_str_std(filter.pattern);
+
+	for (auto&& visible : visible_rows) {
+		auto const& row = visible.row;
+		auto const& line = buffer.line(visible.line);
+		auto text = buffer.text(line).substr(row.offset, row.count);
+
+		// highlight every match in this row
+		if (pattern.count) {
+			u64 offset = 0;
+			for (;;) {
+				u64 at = offset + find_text(text.substr(offset), pattern);
+				if (at == text.count) break;
+
+				Text_Color_State start = {row.color, row.using_color};
+				float x0 = 4.0f + measure_text(layout.font, text.substr(0, at), 0.0f, text_layout::console_colors, start).x;
+				float x1 = 4.0f + measure_text(layout.font, text.substr(0, at + pattern.count), 0.0f, text_layout::console_colors, start).x;
+				engine.renderer_2d.add_rect({x0, x1, top, top + ystride}, color(colors::Yellow, 0.35f));
+
+				offset = at + pattern.count;
+			}
+		}
+
+		Color_Info color_info = {row.color, row.using_color};
+		add_string(r, color_info, text, {4, top});
+		top -= ystride;
+	}
+}
+
 void Console_Layer::draw_console_buffer(Textured_Renderer_2D& r, float top, float ystride) {
-	auto start = buffer_view.data;
-	auto end   = start + buffer_view.count;
-	auto cursor = end - 1;
+	auto& font = engine.fonts.console;
+	float wrap_width = (float)engine.graphics.sc_extent.width - 8.0f;
+	layout.reset(&font, wrap_width, text_layout::console_colors);
+
+	// width changed, every line needs to be laid out again
+	if (layout_width != wrap_width) {
+		layout_width    = wrap_width;
+		layout_end_line = buffer.first_line;
+		for (u64 i = buffer.first_line; i < buffer.end_line; ++i)
+			buffer.line(i).rows = 0;
+	}
 
-	{
-		int newline_count = -1;
-		while (cursor > start) {
-			if (*cursor == '\n')
-				++newline_count;
+	// update the row index for lines that are new or have changed (only the open line can change)
+	u64 open_line = buffer.end_line - 1;
+	for (u64 i = max(min(layout_end_line, open_line), buffer.first_line); i < buffer.end_line; ++i) {
+		auto& line = buffer.line(i);
 
-			--cursor;
+		if (i != buffer.first_line) {
+			auto const& prev = buffer.line(i - 1);
+			line.row_start = prev.row_start + prev.rows;
 		}
+		else if (i >= layout_end_line) line.row_start = 0;
 
-		buffer_view_offset = min(buffer_view_offset, newline_count);
+		// empty open line (text ends with a newline), don't show it
+		if (line.rows || (line.count == 0 && i == open_line)) continue;
 
-		if (buffer_view_offset == newline_count)
-			flags |=  layer::console_end_of_buffer;
-		else
-			flags &=~ layer::console_end_of_buffer;
+		auto size = measure_text(&font, buffer.text(line), wrap_width, text_layout::console_colors, {line.color, line.using_color});
+		line.rows = u32(size.y / font.height + 0.5f);
 	}
+	layout_end_line = open_line;
 
-	int count = -1;
-	cursor = end - 1;
-	while (true) {
-		if (*cursor == '\n')
-			++count;
+	if (filter.active()) {
+		update_filter();
+		draw_filtered_lines(r, top, ystride);
+		return;
+	}
 
-		// this is bad programming, please someone fix this shit
-		if (cursor > start && count < buffer_view_offset); else
-			break;
+	auto const& last = buffer.line(open_line);
+	u64 row_begin = buffer.line(buffer.first_line).row_start;
+	u64 row_end   = last.row_start + last.rows;
+
+	s64 row_count = s64(row_end - row_begin);
+	if (row_count == 0) return;
+
+	buffer_view_offset = (int)max(min((s64)buffer_view_offset, row_count - 1), 0);
+
+	if (buffer_view_offset >= row_count - 1)
+		flags |=  layer::console_end_of_buffer;
+	else
+		flags &=~ layer::console_end_of_buffer;
+
+	Visible_Key key = {
+		.bottom_row = row_end - 1 - buffer_view_offset,
+		.first_line = buffer.first_line,
+		.end_line   = buffer.end_line,
+		.open_count = last.count,
+		.max_rows   = (top >= -ystride) ? u32((top + ystride) / ystride) + 1 : 0,
+		.width      = wrap_width,
+		.filter     = 0,
+	};
+
+	if (!(key == visible_key)) {
+		visible_key = key;
+		visible_rows.clear();
+
+		// find the line with the bottom row, last line with `row_start <= bottom_row`
+		u64 lo = buffer.first_line, hi = buffer.end_line;
+		while (hi - lo > 1) {
+			u64 mid = lo + (hi - lo) / 2;
+			if (buffer.line(mid).row_start <= key.bottom_row) lo = mid;
+			else                                              hi = mid;
+		}
+
+		// lay out only the lines that are on screen, from the bottom up
+		u64 index = lo;
+		s64 row   = s64(key.bottom_row - buffer.line(index).row_start);
+		while (visible_rows.size() < key.max_rows) {
+			auto const& line = buffer.line(index);
+			layout.layout(buffer.text(line), {line.color, line.using_color});
+
+			for (s64 i = min(row, (s64)layout.lines.size() - 1); i >= 0 && visible_rows.size() < key.max_rows; --i)
+				visible_rows.emplace_back(Visible_Row{index, layout.lines[i]});
 
-		--cursor;
+			if (index == buffer.first_line) break;
+			row = s64(buffer.line(--index).rows) - 1;
+		}
 	}
 
-	Color_Info color_info;
-	while (top >= -ystride && cursor > start) {
-		auto str = get_string(cursor, start);
-		
-		add_string(r, color_info, str, {4, top});
+	for (auto&& visible : visible_rows) {
+		auto const& row = visible.row;
+		Color_Info color_info = {row.color, row.using_color};
 
-		cursor = std::max(str.data - 1, start);
+		auto text = buffer.text(buffer.line(visible.line));
+		add_string(r, color_info, text.substr(row.offset, row.count), {4, top});
 		top -= ystride;
-
-		if (cursor == start) break;
 	}
 }
 
 void Console_Layer::on_update(double dt, Render_Context* ctx) {
+	drain_log_queues();
+
 	auto& font = engine.fonts.console;
 	
 	// update current position
@@ -545,7 +1087,7 @@ void Console_Layer::on_update(double dt, Render_Context* ctx) {
 	// Show from user input
 	if(current_command == -1) {
 		tr2d.add_string(input, {4, position}, colors::White);
-		auto width = font.table.fallback.advance;
+		auto width = font.table.fallback().advance;
 		r2d.add_rect(rf32::from_topleft(4+width*float(input_cursor), position+1, 1, font.height-2), colors::White);
 
 	// Show from history
@@ -563,6 +1105,19 @@ void Console_Layer::on_update(double dt, Render_Context* ctx) {
 
 	draw_console_buffer(tr2d, position - font.height, font.height);
 
+	if (filter.active()) {
+		char temp[64];
+		u64 open_line = buffer.end_line - 1;
+		if (filter.scanned_end < open_line) {
+			u64 total = open_line - buffer.first_line;
+			u64 done  = filter.scanned_end - min(filter.scanned_end, buffer.first_line);
+			tr2d.add_string_rtl("searching %i%%"_fmt(temp, total ? int(done * 100 / total) : 0), {screen_width - 4, position}, colors::Gray);
+		}
+		else {
+			tr2d.add_string_rtl("%i matches"_fmt(temp, (int)filter.matches.size()), {screen_width - 4, position}, colors::Gray);
+		}
+	}
+
 	engine.renderer_2d.draw(*ctx);
 	engine.textured_renderer_2d.draw(*ctx);
 }
@@ -0,0 +1,100 @@
+#include <Fission/Core/Console_Script.hh>
+#include <Fission/Core/Console.hh>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+__FISSION_BEGIN__
+
+bool Console_Script::load(string path) {
+	char name[256];
+	auto n = min(path.count, sizeof(name) - 1);
+	memcpy(name, path.data, n);
+	name[n] = 0;
+
+	FILE* file = fopen(name, "rb");
+	if (!file) return false;
+
+	File f = {};
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	// extra byte, commands are allowed to write a null terminator after their arguments
+	f.text.resize(size > 0 ? size + 1 : 1);
+	if (size > 0) f.text.resize(fread(f.text.data(), 1, size, file) + 1);
+	f.text.back() = '\n';
+	fclose(file);
+
+	files.emplace_back(std::move(f));
+	return true;
+}
+
+bool Console_Script::wait(string args) {
+	char temp[32];
+	auto n = min(args.count, sizeof(temp) - 1);
+	memcpy(temp, args.data, n);
+	temp[n] = 0;
+
+	char* end = nullptr;
+	double amount = strtod(temp, &end);
+	while (*end == ' ') ++end;
+
+	if (end == temp || amount < 0.0) return false;
+
+	if (*end == 's') {
+		wait_seconds = amount;
+	}
+	else if (*end == 0 || *end == 'f') { // "frames"
+		wait_frames = (u64)amount;
+	}
+	else return false;
+
+	return true;
+}
+
+void Console_Script::update(double dt) {
+	if (wait_frames) {
+		--wait_frames;
+		return;
+	}
+	if (wait_seconds > 0.0) {
+		wait_seconds -= dt;
+		return;
+	}
+
+	while (!files.empty()) {
+		auto& file = files.back();
+		if (file.cursor >= file.text.size()) {
+			files.pop_back();
+			continue;
+		}
+
+		// next line
+		c8* text  = file.text.data();
+		u64 begin = file.cursor;
+		u64 end   = begin;
+		while (end < file.text.size() && text[end] != '\n') ++end;
+		file.cursor = end + 1;
+
+		while (begin < end && (text[begin] == ' ' || text[begin] == '\t')) ++begin;
+		while (end > begin && (text[end - 1] == '\r' || text[end - 1] == ' ')) --end;
+
+		string line = {.count = end - begin, .data = text + begin};
+		if (line.is_empty() || line.data[0] == '#') continue;
+
+		if (line.count >= 4 && memcmp(line.data, "wait", 4) == 0 && (line.count == 4 || line.data[4] == ' ')) {
+			if (!wait(line.substr(min(line.count, 5)))) {
+				console::print(FS_str("bad wait: "), colors::Red);
+				console::println(line, colors::Red);
+				continue;
+			}
+			return;
+		}
+
+		// `file` may be gone after this (exec)
+		console::execute(line);
+	}
+}
+
+__FISSION_END__
@@ -0,0 +1,72 @@
+#include <Fission/Core/Counters.hh>
+#include <Fission/Core/Trace.hh>
+#include <Fission/Base/Memory.hpp>
+#include <cstring>
+
+__FISSION_BEGIN__
+
+void Counters::create() {
+	samples = (float*)FISSION_TAGGED_ALLOC(max_count * history * sizeof(float), debug);
+	clear();
+}
+
+void Counters::destroy() {
+	FISSION_DEFAULT_FREE(samples);
+	samples = nullptr;
+	count   = 0;
+}
+
+void Counters::clear() {
+	count = 0;
+	frame = 0;
+}
+
+u32 Counters::find_or_add(char const* name, Kind kind) {
+	// the same literal is almost always the same pointer
+	FS_FOR(count) if (names[i] == name) return i;
+	FS_FOR(count) if (strcmp(names[i], name) == 0) return i;
+
+	if (count == max_count) return ~0u;
+
+	// history starts out at 0 for counters added late
+	memset(samples + count * history, 0, history * sizeof(float));
+	names [count] = name;
+	kinds [count] = kind;
+	values[count] = 0.0f;
+	return count++;
+}
+
+u32 Counters::find(string name) const {
+	FS_FOR(count) {
+		if (strlen(names[i]) == name.count && memcmp(names[i], name.data, name.count) == 0) return i;
+	}
+	return ~0u;
+}
+
+void Counters::end_frame() {
+	FS_TRACE_SCOPE("counters");
+	u32 const at = u32(frame++ % history);
+
+	FS_FOR(count) {
+		samples[i * history + at] = values[i];
+		trace::counter(names[i], values[i]);
+		if (kinds[i] == kind_plot) values[i] = 0.0f;
+	}
+}
+
+Counters::Summary Counters::summarize(u32 id) const {
+	u32 n = sample_count();
+	if (n == 0) return {};
+
+	Summary s = {.last = sample(id, n - 1), .min = sample(id, 0), .max = sample(id, 0), .mean = 0.0f};
+	FS_FOR(n) {
+		float v = sample(id, i);
+		s.min   = min(s.min, v);
+		s.max   = max(s.max, v);
+		s.mean += v;
+	}
+	s.mean /= (float)n;
+	return s;
+}
+
+__FISSION_END__
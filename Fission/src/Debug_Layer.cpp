@@ -1,6 +1,9 @@
 #include <Fission/Core/Layer.hh>
 #include <Fission/Core/Engine.hh>
 #include <Fission/Core/Input/Keys.hh>
+#include <Fission/Core/Console.hh>
+#include <Fission/Core/Trace.hh>
+#include <Fission/Base/Time.hpp>
 #include "Version.h"
 #include <format>
 #include <random>
@@ -59,9 +62,13 @@ void copy_to(string s, std::vector<c8>& out) {
 
 void Debug_Layer::create() {
 	frame_count = 128; // wha?
-	frame_times = (float*)FISSION_DEFAULT_ALLOC(frame_count * sizeof(float));
+	frame_times = (float*)FISSION_TAGGED_ALLOC(frame_count * sizeof(float), debug);
 	FS_FOR(frame_count) frame_times[i] = 0.001f;
 
+	frame_stats[0].create(300);
+	frame_stats[1].create(3600);
+	counters.create();
+
 	character_buffer.reserve(512);
 	left_strings.reserve(16);
 	right_strings.reserve(16);
@@ -115,6 +122,8 @@ void Debug_Layer::create() {
 
 void Debug_Layer::destroy() {
 	FISSION_DEFAULT_FREE(frame_times);
+	for (auto&& stats : frame_stats) stats.destroy();
+	counters.destroy();
 }
 
 void Debug_Layer::add(string s) {
@@ -201,59 +210,274 @@ float Debug_Layer::draw_frame_time_graph(v2f32 top_left) {
 #endif
 }
 
+// Short window, only the buckets that have frames in them
+float Debug_Layer::draw_frame_time_histogram(v2f32 top_left) {
+	float const height = 40.0f;
+	float const bottom = top_left.y + height;
+	auto const& stats  = frame_stats[0];
+
+	u32 first = Frame_Stats::bucket_count, last = 0, most = 1;
+	FS_FOR(Frame_Stats::bucket_count) {
+		if (!stats.counts[i]) continue;
+		first = min(first, i);
+		last  = i;
+		most  = max(most, stats.counts[i]);
+	}
+	if (first > last) return 0.0f;
+
+	u32 const hitch_bucket = hitch_budget > 0.0f ? Frame_Stats::bucket(hitch_budget) : Frame_Stats::bucket_count;
+	float const width = 3.0f * (float)(last - first + 1);
+	engine.renderer_2d.add_rect(rf32::from_topleft(top_left, width, height), colors::Black);
+
+	for (u32 i = first; i <= last; ++i) {
+		if (!stats.counts[i]) continue;
+		float h = height * (float)stats.counts[i] / (float)most;
+		float x = top_left.x + 3.0f * (float)(i - first);
+		engine.renderer_2d.add_rect(rf32::from_topleft(x, bottom - h, 2.0f, h), i >= hitch_bucket ? colors::Red : colors::White);
+	}
+	return height;
+}
+
+void Debug_Layer::check_hitch(float dt) {
+	if (hitch_budget <= 0.0f || dt <= hitch_budget) return;
+
+	++hitch_count;
+	last_hitch = dt;
+
+	char buffer[96];
+	if (trace::session) {
+		char file[32];
+		auto name = "hitch_%llu.trace"_fmt(file, (unsigned long long)hitch_count);
+		if (trace::dump(name)) {
+			console::log(console::severity::warning, "hitch: %.2f ms (trace in %s)"_fmt(buffer, dt * 1000.0f, file));
+			return;
+		}
+	}
+	console::log(console::severity::warning, "hitch: %.2f ms"_fmt(buffer, dt * 1000.0f));
+}
+
 bool Debug_Layer::visible() const {
 	return (flags & layer::show) && !(engine.console_layer.flags & layer::show);
 }
 
-void Debug_Layer::on_update(double dt, Render_Context* ctx) {
-	if (++frame_time_index >= frame_count) frame_time_index = 0;
-	frame_times[frame_time_index] = (float)dt;
+// Numbers on the overlay are written by hand, formatting with
+//  printf is a surprising amount of the overlay's time.
+struct Line_Writer {
+	c8  data[96];
+	u32 count = 0;
 
-	if (!visible()) return reset(*this);
+	Line_Writer& add(char const* s) {
+		while (*s && count < std::size(data)) data[count++] = (c8)*s++;
+		return *this;
+	}
 
-	engine.textured_renderer_2d.set_font(&engine.fonts.debug);
+	Line_Writer& number(u64 value) {
+		c8 digits[20];
+		u32 n = 0;
+		do digits[n++] = c8('0' + value % 10); while (value /= 10);
+		while (n && count < std::size(data)) data[count++] = digits[--n];
+		return *this;
+	}
 
-	static constexpr auto bg_color = color(colors::Black, 0.95f);
+	Line_Writer& fixed(double value, u32 decimals) {
+		static constexpr u64 scale[] = {1, 10, 100, 1000, 10000};
+		decimals = min(decimals, 4u);
 
-	float height = engine.fonts.debug.height;
-	float offset = 0.0f;
-	auto add_text = [&](string s) {
-		if (s.count) {
-			auto bounds = engine.textured_renderer_2d.add_string(s, { 0.0f, offset }, colors::White);
-			engine.renderer_2d.add_rect({0.0f, bounds.x+padding, offset, offset+bounds.y}, bg_color);
+		if (value < 0.0) {
+			add("-");
+			value = -value;
 		}
-		offset += height;
-	};
+		if (!(value < 1e15)) return add("inf"); // NaN too
+
+		u64 n = u64(value * double(scale[decimals]) + 0.5);
+		number(n / scale[decimals]);
+		if (decimals) {
+			add(".");
+			u64 fraction = n % scale[decimals];
+			for (u32 d = decimals; d-- > 0 && count < std::size(data);) {
+				data[count++] = c8('0' + fraction / scale[d] % 10);
+			}
+		}
+		return *this;
+	}
+
+	string str() const { return FS_str_make((c8*)data, count); }
+};
+
+static constexpr auto bg_color = color(colors::Black, 0.95f);
+
+static float add_text(string s, float offset, float x = 0.0f) {
+	if (s.count) {
+		auto bounds = engine.textured_renderer_2d.add_string(s, { x, offset }, colors::White);
+		engine.renderer_2d.add_rect({x, x+bounds.x+padding, offset, offset+bounds.y}, bg_color);
+	}
+	return engine.fonts.debug.height;
+}
+
+static float add_text_right(string s, float offset) {
 	float right = (float)engine.graphics.sc_extent.width;
-	auto add_text_right = [&](string s) {
-		if (s.count) {
-			auto bounds = engine.textured_renderer_2d.add_string_rtl(s, { right, offset }, colors::White);
-			engine.renderer_2d.add_rect({right-bounds.x-padding, right, offset, offset + bounds.y}, bg_color);
+	if (s.count) {
+		auto bounds = engine.textured_renderer_2d.add_string_rtl(s, { right, offset }, colors::White);
+		engine.renderer_2d.add_rect({right-bounds.x-padding, right, offset, offset + bounds.y}, bg_color);
+	}
+	return engine.fonts.debug.height;
+}
+
+// One row per counter, every graph is scaled to its own range, newest sample on the right
+float Debug_Layer::draw_counters(v2f32 top_left) {
+	float const height = engine.fonts.debug.height;
+	float const step   = 2.0f;
+	float const width  = step * (float)(Counters::history - 1);
+	u32   const n      = counters.sample_count();
+
+	float y = top_left.y;
+	FS_FOR(counters.count) {
+		auto  s      = counters.summarize(i);
+		float scale  = s.max > s.min ? (height - 2.0f) / (s.max - s.min) : 0.0f;
+		float bottom = y + height - 1.0f;
+
+		engine.renderer_2d.add_rect(rf32::from_topleft(top_left.x, y, width, height), colors::Black);
+		if (n > 1) {
+			float x  = top_left.x + width - step * (float)(n - 1);
+			float y0 = bottom - (counters.sample(i, 0) - s.min) * scale;
+			for (u32 k = 1; k < n; ++k) {
+				float y1 = bottom - (counters.sample(i, k) - s.min) * scale;
+				engine.renderer_2d.add_line({x, y0}, {x + step, y1}, 1.0f, colors::White, colors::White);
+				x += step;
+				y0 = y1;
+			}
 		}
-		offset += height;
+
+		u32 decimals = fabsf(s.max) >= 100.0f ? 0 : 2;
+		add_text(Line_Writer{}.add(counters.names[i]).add(" ").fixed(s.last, decimals)
+			.add("  [").fixed(s.min, decimals).add(", ").fixed(s.max, decimals).add("]").str(), y, top_left.x + width + padding);
+		y += height;
+	}
+	return y - top_left.y;
+}
+
+void Overlay_Geometry::record_begin() {
+	start      = engine.renderer_2d.d;
+	text_start = engine.textured_renderer_2d.d;
+}
+
+void Overlay_Geometry::record_end() {
+	auto keep = [](auto& r, Draw_Data const& start, auto& vertices, std::vector<u16>& indices) {
+		vertices.assign(r.vertex_data + start.total_vtx_count, r.vertex_data + r.d.total_vtx_count);
+		indices .assign(r.index_data  + start.total_idx_count, r.index_data  + r.d.total_idx_count);
+		for (auto&& index : indices) index -= (u16)start.vtx_count;
 	};
+	keep(engine.renderer_2d,          start,      vertices,      indices);
+	keep(engine.textured_renderer_2d, text_start, text_vertices, text_indices);
+}
+
+void Overlay_Geometry::append() {
+	engine.renderer_2d         .add_geometry(vertices.data(),      (u32)vertices.size(),      indices.data(),      (u32)indices.size());
+	engine.textured_renderer_2d.add_geometry(text_vertices.data(), (u32)text_vertices.size(), text_indices.data(), (u32)text_indices.size());
+}
+
+// Text that only moves when the layout changes
+void Debug_Layer::draw_static_text() {
+	auto base = character_buffer.data();
+
+	add_text(app_info_string.absolute(base), 0.0f);
+
+	float offset = 0.0f;
+	for (auto&& s : right_strings) offset += add_text_right(s.absolute(base), offset);
+}
+
+void Debug_Layer::draw_dynamic_text() {
+	float height = engine.fonts.debug.height;
+	float offset = height; // below app info
 
 	float mean_frame_time = 0.0f;
 	FS_FOR(frame_count) mean_frame_time += frame_times[i];
 	mean_frame_time /= (float)frame_count;
 
-	auto base = character_buffer.data();
-	
-	add_text(app_info_string.absolute(base));
+	offset += add_text(Line_Writer{}.fixed(1.0f / mean_frame_time, 1).add(" FPS (").fixed(mean_frame_time * 1000.0f, 2).add(" ms)").str(), offset);
 
-	char buffer[64];
-	add_text("%.1f FPS (%.2f ms)"_fmt(buffer, 1.0f / mean_frame_time, mean_frame_time * 1000.0f));
+	auto const& stats = frame_stats[0];
+	offset += add_text(Line_Writer{}
+		.add("p50 ")  .fixed(stats.quantile(0.50f) * 1000.0f, 2)
+		.add("  p95 ").fixed(stats.quantile(0.95f) * 1000.0f, 2)
+		.add("  p99 ").fixed(stats.quantile(0.99f) * 1000.0f, 2)
+		.add("  max ").fixed(stats.maximum()       * 1000.0f, 2).add(" ms").str(), offset);
+	if (hitch_count) offset += add_text(Line_Writer{}.number(hitch_count).add(" hitches (last ").fixed(last_hitch * 1000.0f, 1).add(" ms)").str(), offset);
 
 	if (flags& layer::debug_show_verbose) {
-		add_text("CPU time: %.4f ms"_fmt(buffer, cpu_time*1000.f));
+		offset += add_text(Line_Writer{}.add("CPU time: ").fixed(cpu_time * 1000.0f, 4).add(" ms").str(), offset);
+
+		auto& gpu = engine.gpu_timer;
+		if (gpu.supported) {
+			offset += add_text(Line_Writer{}.add("GPU time: ").fixed(gpu.frame_ms, 4).add(" ms").str(), offset);
+			FS_FOR(gpu.result_count)
+				offset += add_text(Line_Writer{}.add("  ").add(gpu.results[i].name).add(": ").fixed(gpu.results[i].ms, 4).add(" ms").str(), offset);
+		}
+
+		auto& mem = engine.memory_stats;
+		FS_FOR(mem.heap_count) {
+			auto& heap = mem.heaps[i];
+			offset += add_text(Line_Writer{}.add("heap ").number(i).add(heap.device_local ? " (device): " : ": ")
+				.fixed(double(heap.usage) / double(FS_MEGABYTES(1)), 1).add(" / ")
+				.fixed(double(heap.budget) / double(FS_MEGABYTES(1)), 1).add(" MB").str(), offset);
+		}
+		offset += add_text(Line_Writer{}.add("temp storage: ").number(mem.temp_storage.used >> 10)
+			.add(" KB (peak ").number(mem.temp_storage.peak >> 10).add(" KB)").str(), offset);
+		for (auto&& r : mem.renderers) {
+			offset += add_text(Line_Writer{}.add(r.name).add(": ")
+				.fixed(100.0f * (float)r.peak_vertices / (float)max(r.max_vertices, 1u), 0).add("% vertices, ")
+				.fixed(100.0f * (float)r.peak_indices  / (float)max(r.max_indices,  1u), 0).add("% indices (peak)").str(), offset);
+		}
 		offset += draw_frame_time_graph({0.0f, offset});
+		offset += draw_frame_time_histogram({0.0f, offset + padding}) + padding;
 	}
 	else offset += height;
 
-	for (auto&& s : left_strings) add_text(s.absolute(base));
+	auto base = character_buffer.data();
+	for (auto&& s : left_strings) offset += add_text(s.absolute(base), offset);
+
+	if (counters.count) offset += draw_counters({0.0f, offset + padding});
+}
+
+void Debug_Layer::on_update(double dt, Render_Context* ctx) {
+	if (++frame_time_index >= frame_count) frame_time_index = 0;
+	frame_times[frame_time_index] = (float)dt;
 
-	offset = 0.0f;
-	for (auto&& s : right_strings) add_text_right(s.absolute(base));
+	for (auto&& stats : frame_stats) stats.add((float)dt);
+	check_hitch((float)dt);
+
+	if (!visible()) {
+		// lay everything out again once it is shown
+		layout_key = {};
+		return reset(*this);
+	}
+
+	engine.textured_renderer_2d.set_font(&engine.fonts.debug);
+
+	auto key = Layout_Key{
+		.flags             = flags,
+		.width             = engine.graphics.sc_extent.width,
+		.left_string_count = (u32)left_strings.size(),
+		.font_height       = engine.fonts.debug.height,
+	};
+	bool const layout_changed = !(key == layout_key);
+	layout_key = key;
+
+	if (layout_changed) {
+		static_overlay.record_begin();
+		draw_static_text();
+		static_overlay.record_end();
+	}
+	else static_overlay.append();
+
+	s64 now = timestamp();
+	if (layout_changed || seconds_elasped(last_refresh, now) >= refresh_interval) {
+		last_refresh = now;
+		dynamic_overlay.record_begin();
+		draw_dynamic_text();
+		dynamic_overlay.record_end();
+	}
+	else dynamic_overlay.append();
 
 	engine.renderer_2d         .draw(*ctx);
 	engine.textured_renderer_2d.draw(*ctx);
@@ -2,6 +2,8 @@
 #include "Platform/Common.h"
 #include <Fission/Core/Engine.hh>
 #include <Fission/Core/Console.hh>
+#include <Fission/Core/Trace.hh>
+#include <Fission/Core/Renderer_2D_Capture.hh>
 #include <Fission/Base/Color.hpp>
 #include <Fission/Base/Time.hpp>
 #include <Fission/Base/Memory.hpp>
@@ -51,6 +53,12 @@ Scene_Key cmdline_to_scene_key(platform::Instance const&);
 void enumerate_displays(std::vector<struct Display>& out);
 void add_engine_console_commands();
 
+// Scenes the engine has built in come first, then the app's
+static Scene* create_scene(Scene_Key const& key) {
+	if (key.name() == "r2d_replay") return r2d_capture::create_replay_scene(key);
+	return on_create_scene(key);
+}
+
 string Engine::get_version_string() {
 	return FS_str(FISSION_VERSION_STRV);
 }
@@ -58,6 +66,7 @@ string Engine::get_version_string() {
 void* talloc(u64 size) {
 	auto ptr = (byte*)engine._ts_base + engine._ts_allocated;
 	engine._ts_allocated += u32(size);
+	engine._ts_peak = max(engine._ts_peak, engine._ts_allocated);
 #if defined(FISSION_DEBUG)
 	if (ptr > ((byte*)engine._ts_base + engine._ts_size)) {
 		display_fatal_error("Error", "Allocated past end of temparary storage!");
@@ -84,7 +93,7 @@ int Engine::create(platform::Instance const& instance, Defaults const& defaults)
 	//       but that is such a damn edge case, not worth thinking about for now.
 
 	// setup the console early so we can use it as soon as possible
-	console_layer.setup_console_api();
+	console_layer.setup_console_api(defaults);
 
 #if FS_INCLUDE_EASTER_EGGS
 #include "/dev/easter_eggs_setup.inl"
@@ -94,7 +103,7 @@ int Engine::create(platform::Instance const& instance, Defaults const& defaults)
 
 	enumerate_displays(displays);
 
-	{
+	if (!defaults.headless) {
 		Window_Create_Info info;
 		info.width         = defaults.window_width;
 		info.height        = defaults.window_height;
@@ -104,10 +113,15 @@ int Engine::create(platform::Instance const& instance, Defaults const& defaults)
 		window.create(&info);
 		if (!window.exists()) return 1;
 	}
+	else {
+		window.width  = defaults.window_width;
+		window.height = defaults.window_height;
+	}
 
 	{
 		Graphics_Create_Info info;
-		info.window = &window;
+		info.window = defaults.headless ? nullptr : &window;
+		info.extent = { (u32)defaults.window_width, (u32)defaults.window_height };
 		if (graphics.create(&info)) return 1;
 	}
 
@@ -131,13 +145,23 @@ int Engine::create(platform::Instance const& instance, Defaults const& defaults)
 
 	{
 		next_scene_key = cmdline_to_scene_key(instance);
-		current_scene = on_create_scene(next_scene_key);
+		current_scene = create_scene(next_scene_key);
 
 		if (current_scene == nullptr) {
 			display_fatal_error("Undefined Scene ID", "Provided Scene ID does not exist.");
 			destroy();
 			return 1;
 		}
+
+		// -exec <file> -> run a console script at startup
+		for (auto [key, value] : next_scene_key) {
+			if (key == "exec" && value.type == Scene_Key::Value::String) {
+				if (!console_layer.script.load(value.v_string)) {
+					console::print(FS_str("failed to open script: "), colors::Red);
+					console::println(value.v_string, colors::Red);
+				}
+			}
+		}
 	}
 
 	return 0;
@@ -145,6 +169,9 @@ int Engine::create(platform::Instance const& instance, Defaults const& defaults)
 
 // TODO: need error handling here pls
 int Engine::create_layers() {
+	gpu_timer.create(graphics, graphics_ext.queue_family_index.graphics);
+
+	overlay_render_pass.name = "overlay";
 	overlay_render_pass.create(VK_SAMPLE_COUNT_1_BIT, false);
 	texture_layout.create(graphics);
 	transform_2d.layout.create(graphics);
@@ -236,6 +263,10 @@ int Engine::create_layers() {
 
 // too lazy to do some destructor nice-ty, so this will have to suffice..
 int Engine::destroy() {
+	trace::stop();
+	trace::update();
+	r2d_capture::stop();
+
 	if (graphics.device) {
 		vkDeviceWaitIdle(graphics.device);
 	}
@@ -257,6 +288,14 @@ int Engine::destroy() {
 		vkDestroyFramebuffer(graphics.device, framebuffers[i], nullptr);
 	}
 	overlay_render_pass.destroy();
+	gpu_timer.destroy(graphics);
+	FISSION_DEFAULT_FREE(_ts_base);
+	_ts_base = nullptr;
+
+#if defined(FISSION_TRACK_ALLOCATIONS)
+	// everything the engine made is gone by now, anything left is a leak
+	memory::report_leaks();
+#endif
 	return 0;
 }
 
@@ -279,6 +318,7 @@ void Engine::run() {
 
 	Render_Context render_context{.gfx = &graphics};
 	double dt = 0.0;
+	double scene_dt = fixed_dt;
 
 	fps_last = timestamp();
 #if defined(FISSION_PLATFORM_WINDOWS)
@@ -286,6 +326,10 @@ void Engine::run() {
 #endif
 
 	while (flags& fRunning) {
+		// start/stop tracing between frames, never inside a scope
+		trace::update();
+		FS_TRACE_SCOPE("frame");
+
 		render_context.frame = frame_index & 1;
 
 		write_semaphore = graphics.sc_image_write_semaphore[render_context.frame];
@@ -294,14 +338,17 @@ void Engine::run() {
 
 		//-------------------------------------------------------------------------------------
 		// Check for anything to do before processing the next frame
-		unlikely if (window.is_minimized()) {
+		unlikely if (!graphics.headless && window.is_minimized()) {
 			window.sleep_until_not_minimized();
 		}
 		unlikely if (flags& fChange_Scene) {
-			auto next_scene = on_create_scene(next_scene_key);
-			vkDeviceWaitIdle(graphics.device);
-			delete current_scene;
-			current_scene = next_scene;
+			FS_TRACE_SCOPE("change scene");
+			auto next_scene = create_scene(next_scene_key);
+			if (next_scene) {
+				vkDeviceWaitIdle(graphics.device);
+				delete current_scene;
+				current_scene = next_scene;
+			}
 			flags &=~ fChange_Scene;
 		}
 		unlikely if (flags& fGraphics_Recreate_Swap_Chain) {
@@ -309,6 +356,7 @@ void Engine::run() {
 			flags &=~ fGraphics_Recreate_Swap_Chain;
 		}
 		unlikely if (flags & fFPS_Limiter_Enable) {
+			FS_TRACE_SCOPE("fps limiter");
 #if defined(FISSION_PLATFORM_WINDOWS)
 			auto time_between_frames = s64(1e7f / fps_limit);
 			auto next   = fps_last + time_between_frames;
@@ -326,7 +374,14 @@ void Engine::run() {
 		//-------------------------------------------------------------------------------------
 
 		VkResult vk_result = VK_ERROR_UNKNOWN;
+
+		// offscreen images are used in turn, the fence says when one is free again
+		if (graphics.headless) {
+			render_context.image_index = render_context.frame;
+			vk_result = VK_SUCCESS;
+		}
 		while (vk_result != VK_SUCCESS) {
+			FS_TRACE_SCOPE("acquire");
 			vk_result = vkAcquireNextImageKHR(graphics.device, graphics.swap_chain, UINT64_MAX, write_semaphore, VK_NULL_HANDLE, &render_context.image_index);
 
 			if (vk_result == VK_SUBOPTIMAL_KHR) break;
@@ -340,8 +395,11 @@ void Engine::run() {
 			}
 		}
 
-		vk_check(vkWaitForFences(graphics.device, 1, &fence, VK_TRUE, UINT64_MAX), "[vkWaitForFences] failed");
-		vk_check(vkResetFences(graphics.device, 1, &fence), "[vkResetFences] failed");
+		{
+			FS_TRACE_SCOPE("fence wait");
+			vk_check(vkWaitForFences(graphics.device, 1, &fence, VK_TRUE, UINT64_MAX), "[vkWaitForFences] failed");
+			vk_check(vkResetFences(graphics.device, 1, &fence), "[vkResetFences] failed");
+		}
 
 		//-------------------------------------------------------------------------------------
 
@@ -352,27 +410,39 @@ void Engine::run() {
 
 		VkCommandBufferBeginInfo beginInfo{ VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
 		vkBeginCommandBuffer(render_context.command_buffer, &beginInfo);
+		gpu_timer.begin_frame(&render_context);
 
 		//-------------------------------------------------------------------------------------
 		// Eat any events handled by debug and console layers
-		window.event_queue.pop_all(events);
-		debug_layer  .handle_events(events);
-		console_layer.handle_events(events);
+		{
+			FS_TRACE_SCOPE("events");
+			window.event_queue.pop_all(events);
+			debug_layer  .handle_events(events);
+			console_layer.handle_events(events);
+			console_layer.script.update(scene_dt);
+			console_layer.remote.update(dt);
+		}
 		//-------------------------------------------------------------------------------------
 
-		current_scene->on_update(dt, events, &render_context);
+		{
+			FS_TRACE_SCOPE("scene update");
+			current_scene->on_update(scene_dt, events, &render_context);
+		}
 
 		//-------------------------------------------------------------------------------------
 		// Render console and debug overlay
-		overlay_render_pass.begin(&render_context);
 		{
+			FS_TRACE_SCOPE("overlay");
+			overlay_render_pass.begin(&render_context);
+
 			bind_font(render_context.command_buffer, &fonts.console);
 			console_layer.on_update(dt, &render_context);
 
 			bind_font(render_context.command_buffer, &fonts.debug);
 			debug_layer.on_update(dt, &render_context);
+
+			overlay_render_pass.end(&render_context);
 		}
-		overlay_render_pass.end(&render_context);
 		//-------------------------------------------------------------------------------------
 
 		if (flags & fSave_Currect_Frame) {
@@ -387,7 +457,7 @@ void Engine::run() {
 			range.layerCount = 1;
 			VkImageMemoryBarrier imageBarrier = {};
 			imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-			imageBarrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+			imageBarrier.oldLayout = graphics.sc_final_layout;
 			imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 			imageBarrier.image = image;
 			imageBarrier.subresourceRange = range;
@@ -405,7 +475,7 @@ void Engine::run() {
 			imageBarrier_toReadable.image = image;
 			imageBarrier_toReadable.subresourceRange = range;
 			imageBarrier_toReadable.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			imageBarrier_toReadable.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+			imageBarrier_toReadable.newLayout = graphics.sc_final_layout;
 			imageBarrier_toReadable.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
 			imageBarrier_toReadable.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
 			vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &imageBarrier_toReadable);
@@ -413,8 +483,15 @@ void Engine::run() {
 
 		vkEndCommandBuffer(render_context.command_buffer);
 
-		renderer_2d         .end_render(&render_context);
-		textured_renderer_2d.end_render(&render_context);
+		memory_stats.update();
+		debug_layer.counters.end_frame();
+
+		{
+			FS_TRACE_SCOPE("end_render upload");
+			renderer_2d         .end_render(&render_context);
+			textured_renderer_2d.end_render(&render_context);
+			if (r2d_capture::writer) r2d_capture::end_frame();
+		}
 
 		//-------------------------------------------------------------------------------------
 
@@ -422,33 +499,42 @@ void Engine::run() {
 
 		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 		VkSubmitInfo submitInfo{ VK_STRUCTURE_TYPE_SUBMIT_INFO };
-		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.waitSemaphoreCount = graphics.headless ? 0 : 1;
 		submitInfo.pWaitSemaphores = &write_semaphore;
 		submitInfo.pWaitDstStageMask = waitStages;
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &render_context.command_buffer;
-		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.signalSemaphoreCount = graphics.headless ? 0 : 1;
 		submitInfo.pSignalSemaphores = &read_semaphore;
-		vk_check(vkQueueSubmit(graphics.graphics_queue, 1, &submitInfo, fence), "[vkQueueSubmit] failed");
+		{
+			FS_TRACE_SCOPE("submit");
+			gpu_timer.submit(&render_context);
+			vk_check(vkQueueSubmit(graphics.graphics_queue, 1, &submitInfo, fence), "[vkQueueSubmit] failed");
+		}
 
 		//-------------------------------------------------------------------------------------
 
-		VkPresentInfoKHR presentInfo{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
-		presentInfo.waitSemaphoreCount = 1;
-		presentInfo.pWaitSemaphores = &read_semaphore;
-		presentInfo.swapchainCount = 1;
-		presentInfo.pSwapchains = &graphics.swap_chain;
-		presentInfo.pImageIndices = &render_context.image_index;
-		vk_result = vkQueuePresentKHR(graphics.present_queue, &presentInfo);
-		if (vk_result == VK_ERROR_OUT_OF_DATE_KHR) {
-			if (!(flags& fRunning)) break; // ok, we head out
-			resize();
-		}
-		else if (vk_result != VK_SUCCESS && vk_result != VK_SUBOPTIMAL_KHR) {
-			display_fatal_graphics_error(vk_result, "[vkQueuePresentKHR] failed");
-			return;
+		if (!graphics.headless) {
+			VkPresentInfoKHR presentInfo{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
+			presentInfo.waitSemaphoreCount = 1;
+			presentInfo.pWaitSemaphores = &read_semaphore;
+			presentInfo.swapchainCount = 1;
+			presentInfo.pSwapchains = &graphics.swap_chain;
+			presentInfo.pImageIndices = &render_context.image_index;
+			{
+				FS_TRACE_SCOPE("present");
+				vk_result = vkQueuePresentKHR(graphics.present_queue, &presentInfo);
+			}
+			if (vk_result == VK_ERROR_OUT_OF_DATE_KHR) {
+				if (!(flags& fRunning)) break; // ok, we head out
+				resize();
+			}
+			else if (vk_result != VK_SUCCESS && vk_result != VK_SUBOPTIMAL_KHR) {
+				display_fatal_graphics_error(vk_result, "[vkQueuePresentKHR] failed");
+				return;
+			}
+			if (vk_result == VK_SUBOPTIMAL_KHR) resize();
 		}
-        if (vk_result == VK_SUBOPTIMAL_KHR) resize();
 
 		if (flags & fSave_Currect_Frame) {
 			vkWaitForFences(graphics.device, 1, &fence, VK_TRUE, UINT64_MAX);
@@ -475,6 +561,7 @@ void Engine::run() {
 		//-------------------------------------------------------------------------------------
 		// Calculate next frame time
 		dt = fs::seconds_elasped_and_reset(last_timestamp);
+		scene_dt = (fixed_dt > 0.0) ? fixed_dt : dt;
 		frame_index += 1;
 	}
 
@@ -484,6 +571,10 @@ void Engine::run() {
 }
 
 void Engine::resize() {
+	// offscreen images never change size
+	if (graphics.headless) return;
+
+	FS_TRACE_SCOPE("resize");
     FS_debug_print("> inside resize()\n");
 	if (window.is_minimized())
 		window.sleep_until_not_minimized();
@@ -521,7 +612,8 @@ void Engine::resize() {
     FS_debug_print("> done resizeing!\n");
 }
 
-#define ADD_COMMAND(Name, Body) console::register_command(FS_str(#Name), [](string args) Body)
+// variadic, so commas in the body do not split it into more arguments
+#define ADD_COMMAND(Name, ...) console::register_command(FS_str(#Name), [](string args) __VA_ARGS__)
 
 void add_engine_console_commands() {
 	ADD_COMMAND(vsync, {
@@ -549,6 +641,218 @@ void add_engine_console_commands() {
 		}
 	});
 
+	ADD_COMMAND(exec, {
+		if (!engine.console_layer.script.load(args)) {
+			console::print(FS_str("failed to open script: "), colors::Red);
+			console::println(args, colors::Red);
+		}
+	});
+
+	// quit [exit code], by default exit code is 1 when an assert has failed
+	ADD_COMMAND(quit, {
+		char temp[32];
+		auto n = min(args.count, sizeof(temp) - 1);
+		memcpy(temp, args.data, n);
+		temp[n] = 0;
+
+		if (n) engine.exit_code = atoi(temp);
+		else   engine.exit_code = engine.console_layer.script.failed_assertions ? 1 : 0;
+
+		engine.flags &=~ engine.fRunning;
+	});
+
+	// assert <fps|frame_time_ms|cpu_time_ms|counter name> <op> <value>
+	// `assert` from <cassert> is a function-like macro, without a `(` after it the name is left alone
+	ADD_COMMAND(assert, {
+		char temp[64];
+		auto n = min(args.count, sizeof(temp) - 1);
+		memcpy(temp, args.data, n);
+		temp[n] = 0;
+
+		char  metric[24];
+		char  op[3];
+		float expected;
+		if (sscanf(temp, "%23s %2s %f", metric, op, &expected) != 3) {
+			console::println(FS_str("usage: assert <fps|frame_time_ms|cpu_time_ms|counter> <op> <value>"), colors::Red);
+			return;
+		}
+
+		auto& debug = engine.debug_layer;
+		float mean_frame_time = 0.0f;
+		FS_FOR(debug.frame_count) mean_frame_time += debug.frame_times[i];
+		mean_frame_time /= (float)debug.frame_count;
+
+		float value;
+		     if (strcmp(metric, "fps") == 0)           value = 1.0f / mean_frame_time;
+		else if (strcmp(metric, "frame_time_ms") == 0) value = mean_frame_time * 1000.0f;
+		else if (strcmp(metric, "cpu_time_ms") == 0)   value = debug.cpu_time * 1000.0f;
+		else if (u32 id = debug.counters.find(FS_str_make(metric, strlen(metric))); id != ~0u) {
+			value = debug.counters.summarize(id).last;
+		}
+		else {
+			console::printf(colors::Red, "unknown metric: %s\n", metric);
+			return;
+		}
+
+		bool ok;
+		     if (strcmp(op, "<")  == 0) ok = value <  expected;
+		else if (strcmp(op, "<=") == 0) ok = value <= expected;
+		else if (strcmp(op, ">")  == 0) ok = value >  expected;
+		else if (strcmp(op, ">=") == 0) ok = value >= expected;
+		else if (strcmp(op, "==") == 0) ok = value == expected;
+		else if (strcmp(op, "!=") == 0) ok = value != expected;
+		else {
+			console::printf(colors::Red, "unknown operator: %s\n", op);
+			return;
+		}
+
+		if (ok) {
+			console::printf(colors::Green, "assert passed: %s = %.3f %s %.3f\n", metric, value, op, expected);
+		}
+		else {
+			++engine.console_layer.script.failed_assertions;
+			console::printf(colors::Red, "assert failed: %s = %.3f %s %.3f\n", metric, value, op, expected);
+		}
+	});
+
+	// trace start <file> -> record engine trace scopes to <file> (see tools/trace_convert)
+	// trace stop
+	ADD_COMMAND(trace, {
+		if (args.count > 6 && memcmp(args.data, "start ", 6) == 0) {
+			trace::start(args.substr(6));
+		}
+		else if (args.count > 5 && memcmp(args.data, "ring ", 5) == 0) {
+			args.data[args.count] = 0;
+			trace::start_ring(strtod((char*)args.data + 5, nullptr));
+		}
+		else if (args.count > 5 && memcmp(args.data, "dump ", 5) == 0) {
+			if (!trace::dump(args.substr(5)))
+				console::println(FS_str("nothing to dump, start with: trace ring <seconds>"), colors::Red);
+		}
+		else if (args == "stop") {
+			trace::stop();
+		}
+		else console::println(FS_str("usage: trace start <file> | trace ring <seconds> | trace dump <file> | trace stop"), colors::Red);
+	});
+
+	ADD_COMMAND(r2d, {
+		args.data[args.count] = 0;
+		if (args.count > 8 && memcmp(args.data, "capture ", 8) == 0) {
+			// r2d capture <file> [frames]
+			auto rest  = args.substr(8);
+			u64  split = 0;
+			while (split < rest.count && rest.data[split] != ' ') ++split;
+			u32 frames = (split < rest.count) ? (u32)strtoul((char*)rest.data + split, nullptr, 10) : 0;
+			if (!r2d_capture::start(rest.substr(0, split), frames ? frames : 600))
+				console::println(FS_str("could not open capture file"), colors::Red);
+		}
+		else if (args == "stop") {
+			r2d_capture::stop();
+		}
+		else if (args.count > 7 && memcmp(args.data, "replay ", 7) == 0) {
+			// r2d replay <file> [loops]
+			auto rest  = args.substr(7);
+			u64  split = 0;
+			while (split < rest.count && rest.data[split] != ' ') ++split;
+			s64 loops = (split < rest.count) ? strtoll((char*)rest.data + split, nullptr, 10) : 0;
+
+			engine.next_scene_key.reset(FS_str("r2d_replay"));
+			engine.next_scene_key.add_string(FS_str("file"), rest.substr(0, split));
+			if (loops > 0) engine.next_scene_key.add_int64(FS_str("loops"), loops);
+			engine.flags |= engine.fChange_Scene;
+		}
+		else console::println(FS_str("usage: r2d capture <file> [frames] | r2d stop | r2d replay <file> [loops]"), colors::Red);
+	});
+
+	ADD_COMMAND(stats, {
+		auto& layer = engine.debug_layer;
+		if (args == "reset") {
+			for (auto&& stats : layer.frame_stats) stats.reset();
+			layer.hitch_count = 0;
+			return;
+		}
+		if (args.count > 7 && memcmp(args.data, "window ", 7) == 0) {
+			args.data[args.count] = 0;
+			char* end;
+			auto short_window = strtoul((char*)args.data + 7, &end, 10);
+			auto long_window  = strtoul(end, nullptr, 10);
+			if (short_window == 0) {
+				console::println(FS_str("usage: stats window <frames> [<frames>]"), colors::Red);
+				return;
+			}
+			layer.frame_stats[0].destroy();
+			layer.frame_stats[0].create((u32)short_window);
+			if (long_window) {
+				layer.frame_stats[1].destroy();
+				layer.frame_stats[1].create((u32)long_window);
+			}
+			return;
+		}
+
+		char buffer[128];
+		for (auto&& stats : layer.frame_stats) {
+			console::println("%5u frames: p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms"_fmt(buffer, stats.count(),
+				stats.quantile(0.50f) * 1000.0f, stats.quantile(0.95f) * 1000.0f,
+				stats.quantile(0.99f) * 1000.0f, stats.maximum() * 1000.0f));
+		}
+		console::println("%llu hitches over %.1f ms"_fmt(buffer, (unsigned long long)layer.hitch_count, layer.hitch_budget * 1000.0f));
+	});
+
+	// counters        -> every counter over its history
+	// counters <name> -> one counter, every sample, oldest first
+	// counters clear
+	ADD_COMMAND(counters, {
+		auto& counters = engine.debug_layer.counters;
+		if (args == "clear") return counters.clear();
+
+		if (args.count) {
+			u32 id = counters.find(args);
+			if (id == ~0u) {
+				args.data[args.count] = 0;
+				console::printf(colors::Red, "no counter named \"%s\"\n", (char*)args.data);
+				return;
+			}
+			FS_FOR(counters.sample_count()) console::printf(colors::White, "%g\n", counters.sample(id, i));
+			return;
+		}
+
+		if (counters.count == 0) console::println(FS_str("no counters, add with debug_layer.counter() or debug_layer.plot()"));
+		FS_FOR(counters.count) {
+			auto s = counters.summarize(i);
+			console::printf<192>(colors::White, "%-24s %-7s last %-10g min %-10g mean %-10g max %g\n", counters.names[i],
+				counters.kinds[i] == Counters::kind_plot ? "plot" : "counter", s.last, s.min, s.mean, s.max);
+		}
+	});
+
+	ADD_COMMAND(mem, {
+		engine.memory_stats.update_details();
+		engine.memory_stats.print();
+	});
+
+#if defined(FISSION_TRACK_ALLOCATIONS)
+	ADD_COMMAND(allocs, {
+		if (args == "stacks") {
+			memory::capture_stacks = !memory::capture_stacks;
+			console::println(memory::capture_stacks ? FS_str("capturing callstacks") : FS_str("not capturing callstacks"));
+			return;
+		}
+		FS_FOR(memory::tag_count) {
+			auto stats = memory::tag_stats((memory::Tag)i);
+			if (stats.total_count == 0) continue;
+			console::printf(colors::White, "%-9s %8.1f KB live (%llu), %8.1f KB peak, %llu total\n", memory::tag_names[i],
+				double(stats.live_bytes) / 1024.0, (unsigned long long)stats.live_count,
+				double(stats.peak_bytes) / 1024.0, (unsigned long long)stats.total_count);
+		}
+	});
+#endif
+
+	ADD_COMMAND(hitch, {
+		args.data[args.count] = 0;
+		if (args == "off") engine.debug_layer.hitch_budget = 0.0f;
+		else if (float ms = strtof((char*)args.data, nullptr); ms > 0.0f) engine.debug_layer.hitch_budget = ms / 1000.0f;
+		else console::println(FS_str("usage: hitch <ms> | hitch off"), colors::Red);
+	});
+
 	ADD_COMMAND(fps, {
 		using namespace fs;
 		args.data[args.count] = 0;
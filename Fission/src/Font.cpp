@@ -1,7 +1,9 @@
 #include <Fission/Core/Font.hh>
 #include <Fission/Core/Engine.hh>
 #include <freetype/freetype.h>
+#include <Fission/Base/Memory.hpp>
 #include <MaxRectsBinPack.hpp>
+#include <algorithm>
 
 void display_fatal_error(const char* title, const char* what);
 #define check(X, WHAT) if(X) { display_fatal_error("Font Error", WHAT); return; } (void)0
@@ -12,11 +14,26 @@ extern fs::Engine engine;
 
 using namespace fs;
 
-void Font_Static::create(void const* ttf_data, size_t _size, float _height, VkDescriptorSet set, VkSampler sampler) {
+void Font_Static::create(void const* ttf_data, size_t _size, float _height, VkDescriptorSet set, VkSampler sampler, u32 _subpixel_variants) {
 	FT_Error error = FT_Err_Ok;
 	FT_Face face = nullptr;
 
 	texture = set;
+	subpixel_variants = std::clamp(_subpixel_variants, 1u, max_subpixel_variants);
+	bool const subpixel = subpixel_variants > 1;
+
+	subpixel_base[0] = table.glyphs;
+	if (subpixel) {
+		subpixel_tables = (Glyph_Table_Fast*)FISSION_TAGGED_ALLOC(sizeof(Glyph_Table_Fast) * (subpixel_variants - 1), font);
+		check(!subpixel_tables, "Failed to allocate subpixel glyph tables");
+		memset(subpixel_tables, 0, sizeof(Glyph_Table_Fast) * (subpixel_variants - 1));
+		for (u32 v = 1; v < subpixel_variants; ++v) {
+			subpixel_base[v] = subpixel_tables[v - 1].glyphs;
+		}
+	}
+
+	// hinting snaps outlines to whole pixels, that defeats the point of subpixel positions
+	FT_Int32 const load_flags = subpixel ? (FT_LOAD_RENDER | FT_LOAD_TARGET_LIGHT) : FT_LOAD_RENDER;
 
 	error = FT_New_Memory_Face(engine.fonts.library, (FT_Byte const*)ttf_data, (FT_Long)_size, 0, &face);
 	check(error, "Failed to create font face [FT_New_Memory_Face]");
@@ -28,7 +45,9 @@ void Font_Static::create(void const* ttf_data, size_t _size, float _height, VkDe
 	height = float(face->size->metrics.height >> 6);
 
 	auto _h = u32(face->size->metrics.height >> 6);
-	v2u32 size = { _h * 6, _h * 6 };
+	// every variant needs its own copy of each glyph, double the atlas size to fit them
+	auto _atlas_scale = subpixel ? 2u : 1u;
+	v2u32 size = { _h * 6 * _atlas_scale, _h * 6 * _atlas_scale };
 	auto pixel_data = (rgba8*)calloc(sizeof(rgba8), size.x * size.y);
 	check(!pixel_data, "Failed to allocate pixel data");
 	
@@ -41,11 +60,19 @@ void Font_Static::create(void const* ttf_data, size_t _size, float _height, VkDe
 		auto offsety = (float)(-face->glyph->bitmap_top) + yMax;
 		auto sizex = (float)(face->glyph->metrics.width >> 6);
 		auto sizey = (float)(face->glyph->metrics.height >> 6);
-		g.rc = rf32::from_topleft(offsetx, offsety, sizex, sizey);
 		g.advance = (float)(face->glyph->metrics.horiAdvance >> 6);
 
 		auto bitmap = face->glyph->bitmap;
 
+		if (subpixel) {
+			// shifted outlines can cover one more pixel, use the real bitmap size,
+			//  and keep the fractional advance so the pen position stays exact
+			sizex = (float)bitmap.width;
+			sizey = (float)bitmap.rows;
+			g.advance = (float)face->glyph->linearHoriAdvance / 65536.0f;
+		}
+		g.rc = rf32::from_topleft(offsetx, offsety, sizex, sizey);
+
 		auto rect = pack.Insert(bitmap.width, bitmap.rows, rbp::MaxRectsBinPack::RectBestAreaFit);
 
 		/* now, copy to our target surface */
@@ -63,22 +90,31 @@ void Font_Static::create(void const* ttf_data, size_t _size, float _height, VkDe
 		return g;
 	};
 
-	error = FT_Load_Glyph(face, 0, FT_LOAD_RENDER);
-	check(error, "no fallback");
+	for (u32 variant = 0; variant < subpixel_variants; ++variant) {
+		auto& variant_table = (variant == 0) ? table : subpixel_tables[variant - 1];
 
-	// Set Fallback glyph
-	table.fallback = generate_glyph();
+		if (subpixel) {
+			FT_Vector delta = { .x = FT_Pos(variant * 64 / subpixel_variants), .y = 0 };
+			FT_Set_Transform(face, nullptr, &delta);
+		}
 
-	// Glyph ranges for most english characters, Todo: better font control (languages)
-	for (c32 ch = 0x20; ch < 0x7F; ch++)
-	{
-		if (error = FT_Load_Char(face, ch, FT_LOAD_RENDER))
-			continue;
+		error = FT_Load_Glyph(face, 0, load_flags);
+		check(error, "no fallback");
+
+		// Set Fallback glyph
+		variant_table.fallback() = generate_glyph();
 
-		if (face->glyph->glyph_index == 0) // <-- why?
-			continue;
+		// Glyph ranges for most english characters, Todo: better font control (languages)
+		for (c32 ch = 0x20; ch < 0x7F; ch++)
+		{
+			if (error = FT_Load_Char(face, ch, load_flags))
+				continue;
 
-		table.glyphs[ch - 0x20] = generate_glyph();
+			if (face->glyph->glyph_index == 0) // <-- why?
+				continue;
+
+			variant_table.glyphs[ch - 0x1F] = generate_glyph();
+		}
 	}
 
 	{
@@ -117,11 +153,18 @@ void Font_Static::create(void const* ttf_data, size_t _size, float _height, VkDe
 }
 
 Glyph const* Font_Static::lookup(c32 c) {
-	if (c < 32 || c > 127) return &table.fallback;
-	return &table.glyphs[c - 32];
+	return table.lookup(c);
+}
+
+void Font_Static::lookup_many(string s, Glyph const** out) {
+	table.lookup_many(s, out);
 }
 
 void Font_Static::destroy() {
+	if (subpixel_tables) {
+		FISSION_DEFAULT_FREE(subpixel_tables);
+		subpixel_tables = nullptr;
+	}
 	vkDestroyImageView(engine.graphics.device, atlas_view, nullptr);
 	vmaDestroyImage(engine.graphics.allocator, atlas_image, atlas_allocation);
 }
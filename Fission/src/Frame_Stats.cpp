@@ -0,0 +1,86 @@
+#include <Fission/Core/Frame_Stats.hh>
+#include <Fission/Base/Memory.hpp>
+#include <cstring>
+#include <bit>
+
+__FISSION_BEGIN__
+
+void Frame_Stats::create(u32 _window) {
+	window    = max(_window, 1u);
+	times     = (float*)FISSION_TAGGED_ALLOC(((window * sizeof(float) + 63) & ~size_t(63)), debug);
+	max_queue = (u32*)  FISSION_TAGGED_ALLOC(((window * sizeof(u32)   + 63) & ~size_t(63)), debug);
+	reset();
+}
+
+void Frame_Stats::destroy() {
+	FISSION_DEFAULT_FREE(times);
+	FISSION_DEFAULT_FREE(max_queue);
+	times     = nullptr;
+	max_queue = nullptr;
+}
+
+void Frame_Stats::reset() {
+	frame       = 0;
+	queue_begin = 0;
+	queue_end   = 0;
+	memset(counts, 0, sizeof(counts));
+}
+
+u32 Frame_Stats::bucket(float seconds) {
+	u32 bits = std::bit_cast<u32>(seconds);
+	if (bits >> 31) return 0; // negative
+	u32 index = bits >> (23 - sub_bucket_bits);
+	if (index < (min_exponent << sub_bucket_bits)) return 0;
+	return min(index - (min_exponent << sub_bucket_bits), bucket_count - 1);
+}
+
+float Frame_Stats::bucket_lower(u32 bucket) {
+	return std::bit_cast<float>((bucket + (min_exponent << sub_bucket_bits)) << (23 - sub_bucket_bits));
+}
+
+void Frame_Stats::add(float seconds) {
+	u32 slot = u32(frame % window);
+
+	// oldest frame leaves the window
+	if (frame >= window) {
+		--counts[bucket(times[slot])];
+		if (queue_begin < queue_end && max_queue[queue_begin % window] == slot) ++queue_begin;
+	}
+
+	times[slot] = seconds;
+	++counts[bucket(seconds)];
+
+	// nothing smaller than this frame can be the max again
+	while (queue_begin < queue_end && times[max_queue[(queue_end - 1) % window]] <= seconds) --queue_end;
+	max_queue[queue_end++ % window] = slot;
+
+	++frame;
+}
+
+float Frame_Stats::quantile(float q) const {
+	u32 n = count();
+	if (n == 0) return 0.0f;
+
+	// rank of the frame we want, then find the bucket it falls in
+	float rank = q * float(n - 1);
+	u32   seen = 0;
+	FS_FOR(bucket_count) {
+		if (counts[i] == 0) continue;
+		if (float(seen + counts[i]) > rank) {
+			// spread the frames out evenly inside the bucket
+			float lower = bucket_lower((u32)i);
+			float upper = bucket_lower((u32)i + 1);
+			float t = (rank - float(seen) + 0.5f) / float(counts[i]);
+			return fs::min(lower + (upper - lower) * t, maximum());
+		}
+		seen += counts[i];
+	}
+	return maximum();
+}
+
+float Frame_Stats::maximum() const {
+	if (queue_begin == queue_end) return 0.0f;
+	return times[max_queue[queue_begin % window]];
+}
+
+__FISSION_END__
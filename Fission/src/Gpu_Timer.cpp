@@ -0,0 +1,108 @@
+#include <Fission/Core/Gpu_Timer.hh>
+#include <Fission/Core/Trace.hh>
+#include <vector>
+
+__FISSION_BEGIN__
+
+void Gpu_Timer::create(Graphics& gfx, u32 queue_family) {
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(gfx.physical_device, &props);
+
+	u32 family_count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(gfx.physical_device, &family_count, nullptr);
+	std::vector<VkQueueFamilyProperties> families(family_count);
+	vkGetPhysicalDeviceQueueFamilyProperties(gfx.physical_device, &family_count, families.data());
+
+	u32 valid_bits = (queue_family < family_count) ? families[queue_family].timestampValidBits : 0;
+	supported = valid_bits != 0 && props.limits.timestampPeriod > 0.0f;
+	if (!supported) return;
+
+	ns_per_tick = (double)props.limits.timestampPeriod;
+	valid_mask  = (valid_bits >= 64) ? ~u64(0) : (u64(1) << valid_bits) - 1;
+
+	VkQueryPoolCreateInfo info{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+	info.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+	info.queryCount = 2 * max_regions;
+	for (auto&& frame : frames) {
+		if (vkCreateQueryPool(gfx.device, &info, nullptr, &frame.pool) != VK_SUCCESS) {
+			destroy(gfx);
+			return;
+		}
+		frame.count = 0;
+	}
+}
+
+void Gpu_Timer::destroy(Graphics& gfx) {
+	for (auto&& frame : frames) {
+		if (frame.pool) vkDestroyQueryPool(gfx.device, frame.pool, nullptr);
+		frame.pool = VK_NULL_HANDLE;
+	}
+	supported = false;
+}
+
+void Gpu_Timer::begin_frame(Render_Context* ctx) {
+	if (!supported) return;
+	auto& frame = frames[ctx->frame];
+
+	// read back what this slot recorded last time, its fence has been waited on
+	if (frame.count) {
+		// value + availability for every query
+		u64 data[2 * max_regions][2];
+		vkGetQueryPoolResults(ctx->gfx->device, frame.pool, 0, 2 * frame.count, sizeof(data), data,
+			sizeof(data[0]), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+		u64 first = ~u64(0), last = 0;
+		FS_FOR(frame.count) {
+			if (!data[2*i][1] || !data[2*i + 1][1]) continue;
+			first = min(first, data[2*i][0] & valid_mask);
+			last  = max(last,  data[2*i + 1][0] & valid_mask);
+		}
+
+		auto session = trace::session;
+		auto to_us = [this](u64 ticks) { return u64((double)ticks * ns_per_tick / 1000.0); };
+
+		result_count = 0;
+		FS_FOR(frame.count) {
+			if (!data[2*i][1] || !data[2*i + 1][1]) continue;
+			u64 begin = data[2*i][0] & valid_mask;
+			u64 end   = data[2*i + 1][0] & valid_mask;
+			u64 ticks = (end - begin) & valid_mask;
+
+			results[result_count++] = Result{frame.names[i], float((double)ticks * ns_per_tick * 1e-6)};
+
+			// there is no common clock, GPU work is lined up with when the frame was submitted
+			if (session) {
+				u64 duration = to_us(ticks);
+				session->insert_event({frame.names[i], trace::gpu_thread, (u32)min(duration, (u64)UINT32_MAX),
+					frame.cpu_submit_us + to_us((begin - first) & valid_mask)});
+			}
+		}
+		frame_ms = (last >= first && result_count) ? float((double)((last - first) & valid_mask) * ns_per_tick * 1e-6) : 0.0f;
+	}
+
+	vkCmdResetQueryPool(ctx->command_buffer, frame.pool, 0, 2 * max_regions);
+	frame.count = 0;
+}
+
+void Gpu_Timer::submit(Render_Context* ctx) {
+	if (!supported) return;
+	frames[ctx->frame].cpu_submit_us = profiler::timestamp_ns() / 1000;
+}
+
+u32 Gpu_Timer::begin(Render_Context* ctx, char const* name) {
+	if (!supported) return no_region;
+	auto& frame = frames[ctx->frame];
+	if (frame.count == max_regions) return no_region;
+
+	u32 region = frame.count++;
+	frame.names[region] = name;
+	vkCmdWriteTimestamp(ctx->command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.pool, 2 * region);
+	return region;
+}
+
+void Gpu_Timer::end(Render_Context* ctx, u32 region) {
+	if (region == no_region) return;
+	vkCmdWriteTimestamp(ctx->command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frames[ctx->frame].pool, 2 * region + 1);
+}
+
+__FISSION_END__
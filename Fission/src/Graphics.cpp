@@ -7,6 +7,7 @@
 #define VMA_IMPLEMENTATION
 #include <Fission/Core/Engine.hh>
 #include <Fission/Core/Console.hh>
+#include <Fission/Core/Trace.hh>
 #include "Version.h"
 #include <optional>
 #include <algorithm>
@@ -14,13 +15,6 @@
 
 extern fs::Engine engine;
 
-#ifdef PROFILE
-#include "profiler.hpp"
-#define SCOPED_TRACE(NAME) profiler::scoped_trace __trace{session.get(), 0, NAME}
-extern std::unique_ptr<profiler::Session> session;
-#else
-#define SCOPED_TRACE(NAME)
-#endif
 
 #undef assert // yeah? fuck you too
 #define count32 (uint32_t)std::size
@@ -113,8 +107,9 @@ Queue_Indicies findDeviceQueueFamilies(VkPhysicalDevice physical_device, VkSurfa
 			}
 		}
 
-		VkBool32 supports_surface = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, i, surface, &supports_surface);
+		// headless, nothing is presented, any graphics queue will do
+		VkBool32 supports_surface = (flags & VK_QUEUE_GRAPHICS_BIT) != 0;
+		if (surface) vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, i, surface, &supports_surface);
 
 		if (!families.present.has_value() && supports_surface)
 			families.present = std::make_optional(i);
@@ -246,10 +241,42 @@ SwapChainResult createSwapChain(Swap_Chain_Create_Info& info)
 
 __FISSION_BEGIN__
 
+// Stand-ins for the swap chain images when headless,
+//  same format and usage so render passes and screenshots work the same
+static VkResult create_offscreen_images(Graphics& gfx, VkExtent2D extent) {
+	gfx.sc_extent       = extent;
+	gfx.sc_format       = VK_FORMAT_B8G8R8A8_UNORM;
+	gfx.sc_present_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+	gfx.sc_image_count  = 2;
+
+	VkImageCreateInfo imageInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+	imageInfo.imageType     = VK_IMAGE_TYPE_2D;
+	imageInfo.format        = gfx.sc_format;
+	imageInfo.extent        = {extent.width, extent.height, 1};
+	imageInfo.mipLevels     = 1;
+	imageInfo.arrayLayers   = 1;
+	imageInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage         = gfx.sc_image_usage;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	VmaAllocationCreateInfo allocInfo{.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE};
+
+	foru32(gfx.sc_image_count) {
+		if (auto r = vmaCreateImage(gfx.allocator, &imageInfo, &allocInfo, gfx.sc_images + i, gfx.sc_image_allocations + i, nullptr)) return r;
+		auto viewInfo = vk::image_view_2d(gfx.sc_images[i], gfx.sc_format);
+		if (auto r = vkCreateImageView(gfx.device, &viewInfo, nullptr, gfx.sc_image_views + i)) return r;
+	}
+	return VK_SUCCESS;
+}
+
 bool Graphics::create(Graphics_Create_Info* info)
 {
+	headless = (info->window == nullptr);
+	sc_final_layout = headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
 	{
-		SCOPED_TRACE("vkCreateInstance");
+		FS_TRACE_SCOPE("vkCreateInstance");
 		VkInstanceCreateInfo info{VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
 
 		VkApplicationInfo appInfo{VK_STRUCTURE_TYPE_APPLICATION_INFO};
@@ -261,18 +288,20 @@ bool Graphics::create(Graphics_Create_Info* info)
 		info.pApplicationInfo = &appInfo;
 
 		const char* Extensions[] = {
+#ifdef FISSION_DEBUG
+			VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
+#endif
 			VK_KHR_SURFACE_EXTENSION_NAME,
 #if defined(FISSION_PLATFORM_WINDOWS)
 			VK_KHR_WIN32_SURFACE_EXTENSION_NAME,
 #elif defined(FISSION_PLATFORM_LINUX)
             VK_KHR_XCB_SURFACE_EXTENSION_NAME,
-#endif
-#ifdef FISSION_DEBUG
-			VK_EXT_DEBUG_UTILS_EXTENSION_NAME,
 #endif
 		};
 
-		info.enabledExtensionCount = count32(Extensions);
+		// headless needs no surface extensions, they might not even be there
+		u32 const surface_extension_count = 2;
+		info.enabledExtensionCount = count32(Extensions) - (headless ? surface_extension_count : 0);
 		info.ppEnabledExtensionNames = Extensions;
 
 #ifdef FISSION_DEBUG
@@ -306,15 +335,15 @@ bool Graphics::create(Graphics_Create_Info* info)
 	}
 #endif
 
-	{
+	if (!headless) {
 #if defined(FISSION_PLATFORM_WINDOWS)
-		SCOPED_TRACE("vkCreateWin32SurfaceKHR");
+		FS_TRACE_SCOPE("vkCreateWin32SurfaceKHR");
 		VkWin32SurfaceCreateInfoKHR surfaceInfo{VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR};
 		surfaceInfo.hwnd = info->window->_handle;
 		surfaceInfo.hinstance = GetModuleHandleW(nullptr);
 		check_result(vkCreateWin32SurfaceKHR(instance, &surfaceInfo, nullptr, &surface), "Failed to create Win32 surface");
 #elif defined(FISSION_PLATFORM_LINUX)
-        SCOPED_TRACE("vkCreateXcbSurfaceKHR");
+        FS_TRACE_SCOPE("vkCreateXcbSurfaceKHR");
         FS_debug_printf("win:%u conn:%p\n", info->window->_id, info->window->_connection);
         VkXcbSurfaceCreateInfoKHR surfaceInfo{VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR};
         surfaceInfo.connection = info->window->_connection;
@@ -324,7 +353,7 @@ bool Graphics::create(Graphics_Create_Info* info)
 	}
 
 	{
-		SCOPED_TRACE("vkCreateWin32SurfaceKHR");
+		FS_TRACE_SCOPE("vkEnumeratePhysicalDevices");
 		u32 deviceCount;
 		vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
 
@@ -381,7 +410,7 @@ bool Graphics::create(Graphics_Create_Info* info)
 		ext.queue_family_index.transfer = *queue_families.transfer;
 	}
 	{
-		SCOPED_TRACE("vkCreateDevice");
+		FS_TRACE_SCOPE("vkCreateDevice");
 
 		float queuePriority = 1.0f;
 		VkDeviceQueueCreateInfo queue_create_info{VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO};
@@ -405,7 +434,8 @@ bool Graphics::create(Graphics_Create_Info* info)
 			VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 		//	VK_EXT_FULL_SCREEN_EXCLUSIVE_EXTENSION_NAME,
 		};
-		deviceInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+		// VK_KHR_swapchain requires VK_KHR_surface, which a headless instance does not enable
+		deviceInfo.enabledExtensionCount = headless ? 0 : static_cast<uint32_t>(deviceExtensions.size());
 		deviceInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
 #ifdef FISSION_DEBUG
@@ -437,8 +467,8 @@ bool Graphics::create(Graphics_Create_Info* info)
 		vkGetDeviceQueue(device, ext.queue_family_index.transfer, 0, &transfer_queue);
 	}
 
-	{
-		SCOPED_TRACE("createSwapChain");
+	if (!headless) {
+		FS_TRACE_SCOPE("createSwapChain");
 		sc_image_usage = FISSION_DEFAULT_SWAP_CHAIN_USAGE;
 
 		Swap_Chain_Create_Info sc_info{
@@ -456,24 +486,24 @@ bool Graphics::create(Graphics_Create_Info* info)
 		check_result(result, "Failed to create swap chain");
 		sc_extent = extent;
 		sc_format = format;
-	}
 	
-	vkGetSwapchainImagesKHR(device, swap_chain, &sc_image_count, nullptr);
-	if(sc_image_count > Graphics::max_sc_images) {
-		display_fatal_graphics_error(
-			std::format("image count is {}, but expected to be less than or equal to {}", sc_image_count, Graphics::max_sc_images)
-			.c_str());
-		return true;
-	}
+		vkGetSwapchainImagesKHR(device, swap_chain, &sc_image_count, nullptr);
+		if(sc_image_count > Graphics::max_sc_images) {
+			display_fatal_graphics_error(
+				std::format("image count is {}, but expected to be less than or equal to {}", sc_image_count, Graphics::max_sc_images)
+				.c_str());
+			return true;
+		}
+
+		vkGetSwapchainImagesKHR(device, swap_chain, &sc_image_count, sc_images);
 
-	vkGetSwapchainImagesKHR(device, swap_chain, &sc_image_count, sc_images);
-	{
 		auto createInfo = vk::image_view_2d(VK_NULL_HANDLE, sc_format);
 		foru32(sc_image_count) {
 			createInfo.image = sc_images[i];
 			check_result(vkCreateImageView(device, &createInfo, nullptr, sc_image_views + i), "Failed to create swap chain ImageView");
 		}
 	}
+	else sc_image_usage = FISSION_DEFAULT_SWAP_CHAIN_USAGE;
 
 	{
 		VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
@@ -513,7 +543,7 @@ bool Graphics::create(Graphics_Create_Info* info)
 	}
 
 	{
-		SCOPED_TRACE("vmaCreateAllocator");
+		FS_TRACE_SCOPE("vmaCreateAllocator");
 		VmaAllocatorCreateInfo allocatorCreateInfo = {
 			.flags = VMA_ALLOCATOR_CREATE_EXTERNALLY_SYNCHRONIZED_BIT,
 			.physicalDevice = physical_device,
@@ -523,10 +553,15 @@ bool Graphics::create(Graphics_Create_Info* info)
 		check_result(vmaCreateAllocator(&allocatorCreateInfo, &allocator), "Failed to create Vulkan Memory Allocator");
 	}
 
+	if (headless) {
+		check_result(create_offscreen_images(*this, info->extent), "Failed to create offscreen images");
+	}
+
 	return false;
 }
 
 void Graphics::recreate_swap_chain(Window* wnd) {
+	if (headless) return;
 	vkDeviceWaitIdle(device);
 	foru32(sc_image_count) {
 		vkDestroyImageView(device, sc_image_views[i], nullptr);
@@ -726,6 +761,14 @@ version Graphics::get_api_version() {
 }
 
 Graphics::~Graphics() {
+	// offscreen images belong to the allocator
+	if (headless) {
+		foru32(sc_image_count) {
+			if (sc_image_views[i]) vkDestroyImageView(device, sc_image_views[i], nullptr);
+			if (sc_images[i])      vmaDestroyImage(allocator, sc_images[i], sc_image_allocations[i]);
+		}
+		sc_image_count = 0;
+	}
 	if(allocator) vmaDestroyAllocator(allocator);
 
 	if (command_pool) {
@@ -774,7 +817,7 @@ void Render_Pass::create(VkSampleCountFlagBits samples, bool clear)
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.initialLayout = clear? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-	colorAttachment.finalLayout = (clear||samples != VK_SAMPLE_COUNT_1_BIT)? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	colorAttachment.finalLayout = (clear||samples != VK_SAMPLE_COUNT_1_BIT)? VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL : engine.graphics.sc_final_layout;
 
 	VkAttachmentDescription colorAttachmentResolve{};
 	colorAttachmentResolve.format = engine.graphics.sc_format;
@@ -834,6 +877,7 @@ void Render_Pass::begin(Render_Context* ctx, VkFramebuffer fb, color clear) {
 	beginInfo.pClearValues = &clear_value;
 	beginInfo.renderArea.extent = ctx->gfx->sc_extent;
 	beginInfo.renderArea.offset = {0, 0};
+	gpu_region = engine.gpu_timer.begin(ctx, name);
 	vkCmdBeginRenderPass(ctx->command_buffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
 }
 void Render_Pass::begin(Render_Context* ctx, color clear) {
@@ -846,6 +890,7 @@ void Render_Pass::begin(Render_Context* ctx, VkFramebuffer fb) {
 	beginInfo.clearValueCount = 0;
 	beginInfo.renderArea.extent = ctx->gfx->sc_extent;
 	beginInfo.renderArea.offset = { 0, 0 };
+	gpu_region = engine.gpu_timer.begin(ctx, name);
 	vkCmdBeginRenderPass(ctx->command_buffer, &beginInfo, VK_SUBPASS_CONTENTS_INLINE);
 }
 void Render_Pass::begin(Render_Context* ctx) {
@@ -853,6 +898,7 @@ void Render_Pass::begin(Render_Context* ctx) {
 }
 void Render_Pass::end(Render_Context* ctx) {
 	vkCmdEndRenderPass(ctx->command_buffer);
+	engine.gpu_timer.end(ctx, gpu_region);
 }
 
 __FISSION_END__
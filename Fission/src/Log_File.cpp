@@ -0,0 +1,165 @@
+#include <Fission/Core/Log_File.hh>
+#include <Fission/Base/Memory.hpp>
+#include <filesystem>
+#include <cstring>
+
+#define ESCAPE 0x1b
+
+__FISSION_BEGIN__
+
+bool Log_File::open(string _path, u64 _max_file_size, u32 _max_files) {
+	close();
+
+	path          = std::string(_path.str());
+	max_file_size = _max_file_size;
+	max_files     = max(_max_files, 1u);
+
+	// keep the log from last time around
+	std::error_code ec;
+	if (std::filesystem::file_size(path, ec) > 0 && !ec) rotate();
+
+	file = fopen(path.c_str(), "wb");
+	if (!file) return false;
+
+	chunks = (Chunk*)FISSION_TAGGED_ALLOC(chunk_count * sizeof(Chunk), console);
+	FS_FOR(chunk_count) chunks[i].count = 0;
+
+	file_size      = 0;
+	dropped        = 0;
+	color_bytes    = 0;
+	using_color    = false;
+	frames_since_hand_off = 0;
+	chunks_filled  = 0;
+	chunks_written = 0;
+	stop           = false;
+
+	writer = std::thread(&Log_File::writer_main, this);
+	return true;
+}
+
+void Log_File::close() {
+	if (!chunks) return;
+
+	hand_off();
+
+	stop.store(true, std::memory_order_release);
+	wake.fetch_add(1, std::memory_order_release);
+	wake.notify_one();
+	writer.join();
+
+	if (file) fclose(file);
+	file = nullptr;
+
+	FISSION_DEFAULT_FREE(chunks);
+	chunks = nullptr;
+}
+
+void Log_File::write(string text) {
+	if (!chunks) return;
+
+	u64 filled = chunks_filled.load(std::memory_order_relaxed);
+
+	FS_FOR(text.count) {
+		c8 c = text.data[i];
+
+		// color codes are of no use in a text file
+		if (color_bytes) { --color_bytes; continue; }
+		if (c == ESCAPE) {
+			if (!using_color) color_bytes = 3;
+			using_color = !using_color;
+			continue;
+		}
+
+		// every chunk is waiting to be written, never wait for the writer
+		if (filled - chunks_written.load(std::memory_order_acquire) == chunk_count) {
+			++dropped;
+			continue;
+		}
+
+		auto& chunk = chunks[filled & (chunk_count - 1)];
+
+		if (dropped && chunk.count == 0) {
+			char temp[64];
+			auto note = "[%llu bytes of console output dropped]\n"_fmt(temp, (unsigned long long)dropped);
+			memcpy(chunk.data, note.data, note.count);
+			chunk.count = note.count;
+			dropped = 0;
+		}
+
+		chunk.data[chunk.count++] = c;
+
+		if (chunk.count == chunk_size) {
+			hand_off();
+			filled = chunks_filled.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void Log_File::flush() {
+	if (!chunks) return;
+
+	// about half a second at 60 fps, keeps chunks big while still
+	//  getting text to disk soon enough to survive a crash
+	if (++frames_since_hand_off >= 30) hand_off();
+}
+
+void Log_File::hand_off() {
+	frames_since_hand_off = 0;
+
+	u64 filled = chunks_filled.load(std::memory_order_relaxed);
+	if (filled - chunks_written.load(std::memory_order_acquire) == chunk_count) return;
+
+	if (chunks[filled & (chunk_count - 1)].count == 0) return;
+
+	chunks_filled.store(filled + 1, std::memory_order_release);
+	wake.fetch_add(1, std::memory_order_release);
+	wake.notify_one();
+}
+
+void Log_File::rotate() {
+	std::error_code ec;
+
+	auto numbered = [this](u32 n) {
+		return (n == 0) ? path : path + '.' + std::to_string(n);
+	};
+
+	std::filesystem::remove(numbered(max_files - 1), ec);
+	for (u32 n = max_files - 1; n > 0; --n) {
+		std::filesystem::rename(numbered(n - 1), numbered(n), ec);
+	}
+}
+
+void Log_File::writer_main() {
+	u64 next = 0;
+
+	for (;;) {
+		u32 w = wake.load(std::memory_order_acquire);
+
+		if (next == chunks_filled.load(std::memory_order_acquire)) {
+			if (stop.load(std::memory_order_acquire)) break;
+			wake.wait(w, std::memory_order_acquire);
+			continue;
+		}
+
+		auto& chunk = chunks[next & (chunk_count - 1)];
+
+		// if the file could not be opened again, keep the queue moving anyway
+		if (file) {
+			fwrite(chunk.data, 1, chunk.count, file);
+			fflush(file);
+			file_size += chunk.count;
+
+			if (file_size >= max_file_size) {
+				fclose(file);
+				rotate();
+				file = fopen(path.c_str(), "wb");
+				file_size = 0;
+			}
+		}
+
+		chunk.count = 0;
+		chunks_written.store(++next, std::memory_order_release);
+	}
+}
+
+__FISSION_END__
@@ -1,12 +1,7 @@
 #include <Fission/Core/Engine.hh>
+#include <Fission/Core/Trace.hh>
 #include "Version.h"
 
-#if PROFILE
-#define PROFILER_IMPLEMENTATION
-#include "profiler.hpp"
-std::unique_ptr<profiler::Session> session;
-#endif
-
 fs::Engine engine {
 	.version = {FISSION_VERSION_MAJ,FISSION_VERSION_MIN,FISSION_VERSION_PAT},
 };
@@ -17,6 +12,12 @@ FISSION_MAIN_FUNCTION()
 {
 	platform::Instance instance = { FISSION_MAIN_ARGS };
 
+#ifdef PROFILE
+	// trace startup too, `trace start` would be too late for that
+	trace::start(FS_str("fission.trace"));
+	trace::update();
+#endif
+
 	if (int r = engine.create(instance, on_create()))
 		return r;
 
@@ -25,5 +26,5 @@ FISSION_MAIN_FUNCTION()
 	if (int r = engine.destroy())
 		return r;
 
-	return 0;
+	return engine.exit_code;
 }
@@ -0,0 +1,92 @@
+#include <Fission/Core/Memory_Stats.hh>
+#include <Fission/Core/Engine.hh>
+#include <Fission/Core/Console.hh>
+#include <Fission/Core/Trace.hh>
+
+extern fs::Engine engine;
+
+__FISSION_BEGIN__
+
+static void update_renderer(Memory_Stats::Renderer& r, Draw_Data const& d, u32 max_vertices, u32 max_indices) {
+	r.vertices      = d.total_vtx_count;
+	r.indices       = d.total_idx_count;
+	r.peak_vertices = max(r.peak_vertices, r.vertices);
+	r.peak_indices  = max(r.peak_indices,  r.indices);
+	r.max_vertices  = max_vertices;
+	r.max_indices   = max_indices;
+}
+
+void Memory_Stats::update() {
+	FS_TRACE_SCOPE("memory stats");
+	auto allocator = engine.graphics.allocator;
+
+	VkPhysicalDeviceMemoryProperties const* props;
+	vmaGetMemoryProperties(allocator, &props);
+	heap_count = props->memoryHeapCount;
+
+	VmaBudget budgets[VK_MAX_MEMORY_HEAPS];
+	vmaGetHeapBudgets(allocator, budgets);
+
+	FS_FOR(heap_count) {
+		auto& heap = heaps[i];
+		heap.budget           = budgets[i].budget;
+		heap.usage            = budgets[i].usage;
+		heap.block_bytes      = budgets[i].statistics.blockBytes;
+		heap.allocation_bytes = budgets[i].statistics.allocationBytes;
+		heap.block_count      = budgets[i].statistics.blockCount;
+		heap.allocation_count = budgets[i].statistics.allocationCount;
+		heap.device_local     = props->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+	}
+
+	if (frame++ % detail_interval == 0) update_details();
+
+	temp_storage.used = engine._ts_allocated;
+	temp_storage.peak = engine._ts_peak;
+	temp_storage.size = engine._ts_size;
+
+	update_renderer(renderers[0], engine.renderer_2d.d, engine.renderer_2d.max_vertex_count, engine.renderer_2d.max_index_count);
+	update_renderer(renderers[1], engine.textured_renderer_2d.d, engine.textured_renderer_2d.max_vertex_count, engine.textured_renderer_2d.max_index_count);
+
+	// trends are easier to see as graphs (and in traces)
+	u64 device_usage = 0;
+	FS_FOR(heap_count) if (heaps[i].device_local) device_usage += heaps[i].usage;
+	engine.debug_layer.counter(device_memory_counter, "device memory (MB)", float(double(device_usage) / double(FS_MEGABYTES(1))));
+	engine.debug_layer.counter(temp_storage_counter,  "temp storage (KB)",  float(temp_storage.used >> 10));
+}
+
+void Memory_Stats::update_details() {
+	VmaTotalStatistics total;
+	vmaCalculateStatistics(engine.graphics.allocator, &total);
+
+	FS_FOR(heap_count) {
+		auto& d = total.memoryHeap[i];
+		heaps[i].unused_range_count   = d.unusedRangeCount;
+		heaps[i].largest_unused_range = d.unusedRangeCount ? d.unusedRangeSizeMax : 0;
+		heaps[i].largest_allocation   = d.statistics.allocationCount ? d.allocationSizeMax : 0;
+	}
+}
+
+static constexpr double MB = 1.0 / double(FS_MEGABYTES(1));
+
+void Memory_Stats::print() const {
+	FS_FOR(heap_count) {
+		auto& heap = heaps[i];
+		console::printf(colors::White, "heap %u%s: %.1f / %.1f MB used\n", (u32)i, heap.device_local ? " (device)" : "",
+			double(heap.usage) * MB, double(heap.budget) * MB);
+		console::printf(colors::Gray, "  %u blocks %.1f MB, %u allocations %.1f MB, largest %.2f MB\n",
+			heap.block_count, double(heap.block_bytes) * MB,
+			heap.allocation_count, double(heap.allocation_bytes) * MB, double(heap.largest_allocation) * MB);
+		console::printf(colors::Gray, "  %u free ranges, largest %.2f MB\n",
+			heap.unused_range_count, double(heap.largest_unused_range) * MB);
+	}
+
+	console::printf(colors::White, "%s: %llu / %llu KB (peak %llu KB)\n", temp_storage.name,
+		(unsigned long long)(temp_storage.used >> 10), (unsigned long long)(temp_storage.size >> 10), (unsigned long long)(temp_storage.peak >> 10));
+
+	for (auto&& r : renderers) {
+		console::printf<256>(colors::White, "%s: %u / %u vertices (peak %u), %u / %u indices (peak %u)\n", r.name,
+			r.vertices, r.max_vertices, r.peak_vertices, r.indices, r.max_indices, r.peak_indices);
+	}
+}
+
+__FISSION_END__
@@ -0,0 +1,224 @@
+#include <Fission/Base/Memory.hpp>
+
+#if defined(FISSION_TRACK_ALLOCATIONS)
+#include <cstdio>
+#if defined(FISSION_PLATFORM_WINDOWS)
+#include <Windows.h>
+#elif defined(FISSION_PLATFORM_LINUX)
+#include <execinfo.h>
+#endif
+
+__FISSION_BEGIN__
+
+namespace memory {
+	std::atomic<bool> capture_stacks = false;
+
+	// Every thread records its allocations in its own table, any thread can free them.
+	//
+	// Only the owner puts entries in (into empty or removed slots), removing is a
+	//  compare-exchange on the pointer, so no locks are needed either way.
+	//  Tables live for as long as the process, threads that exit leave theirs behind.
+	//
+	// Removed entries stay in the way of lookups until the owner clears them, so entries
+	//  are only ever placed within `max_probe` slots of where they hash to. Looking for a
+	//  pointer a table does not have costs at most that much, however many were removed.
+	struct alignas(64) Table {
+		static constexpr u32 capacity  = 1 << 14; // power of 2
+		static constexpr u32 max_live  = capacity / 4 * 3;
+		static constexpr u32 max_probe = 64;
+
+		struct Entry {
+			std::atomic<void*> ptr;
+			std::atomic<u64>   size;
+			std::atomic<u32>   stack;
+			std::atomic<u8>    tag;
+		};
+
+		Entry             entries[capacity];
+		std::atomic<u32>  live     = 0;
+		std::atomic<u64>  untracked = 0; // did not fit (table full or no free slot close enough), these will never show up as leaks
+		Table*            next     = nullptr;
+	};
+
+	// marks a removed entry, lookups keep going past it
+	static void* const removed = (void*)1;
+
+	static std::atomic<Table*> tables = nullptr;
+	static thread_local Table* thread_table = nullptr;
+
+	struct alignas(64) Tag_Counters {
+		std::atomic<u64> live_bytes;
+		std::atomic<u64> peak_bytes;
+		std::atomic<u64> live_count;
+		std::atomic<u64> total_count;
+	};
+	static Tag_Counters counters[tag_count];
+
+	static u32 slot_of(void* ptr) {
+		// allocations are 64 byte aligned, the low bits say nothing
+		return u32(((uintptr_t)ptr >> 6) * 0x9E3779B97F4A7C15ull >> 40) & (Table::capacity - 1);
+	}
+
+	static Table* get_table() {
+		if (thread_table) return thread_table;
+
+		auto table = new (FISSION_UNTRACKED_ALLOC(sizeof(Table))) Table;
+		table->next = tables.load(std::memory_order_relaxed);
+		while (!tables.compare_exchange_weak(table->next, table, std::memory_order_release, std::memory_order_relaxed));
+
+		return thread_table = table;
+	}
+
+	static u32 stack_hash() {
+#if defined(FISSION_PLATFORM_WINDOWS)
+		void* frames[16];
+		ULONG hash = 0;
+		RtlCaptureStackBackTrace(2, (ULONG)std::size(frames), frames, &hash);
+		return (u32)hash;
+#elif defined(FISSION_PLATFORM_LINUX)
+		void* frames[16];
+		int count = backtrace(frames, (int)std::size(frames));
+		u32 hash = 2166136261u; // FNV-1a
+		for (int i = 2; i < count; ++i) {
+			hash ^= u32((uintptr_t)frames[i] ^ ((uintptr_t)frames[i] >> 32));
+			hash *= 16777619u;
+		}
+		return hash;
+#else
+		return 0;
+#endif
+	}
+
+	void* tracked_alloc(u64 size, Tag tag) {
+		void* ptr = FISSION_UNTRACKED_ALLOC(size);
+		if (!ptr) return nullptr;
+
+		auto& c = counters[tag];
+		c.total_count.fetch_add(1, std::memory_order_relaxed);
+
+		auto table = get_table();
+		if (table->live.load(std::memory_order_relaxed) >= Table::max_live) {
+			table->untracked.fetch_add(1, std::memory_order_relaxed);
+			return ptr;
+		}
+
+		u32 stack = capture_stacks.load(std::memory_order_relaxed) ? stack_hash() : 0;
+
+		u32 slot = slot_of(ptr);
+		FS_FOR(Table::max_probe) {
+			auto& e = table->entries[slot];
+			void* current = e.ptr.load(std::memory_order_relaxed);
+			if (current == nullptr || current == removed) {
+				// only allocations that can be found again count as live, `tracked_free` takes them off
+				u64 live = c.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+				u64 peak = c.peak_bytes.load(std::memory_order_relaxed);
+				while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+				c.live_count.fetch_add(1, std::memory_order_relaxed);
+
+				// nobody else ever fills a slot, everything is in place before the pointer is
+				e.size .store(size,  std::memory_order_relaxed);
+				e.stack.store(stack, std::memory_order_relaxed);
+				e.tag  .store(tag,   std::memory_order_relaxed);
+				e.ptr  .store(ptr,   std::memory_order_release);
+				table->live.fetch_add(1, std::memory_order_relaxed);
+				return ptr;
+			}
+			slot = (slot + 1) & (Table::capacity - 1);
+		}
+
+		table->untracked.fetch_add(1, std::memory_order_relaxed);
+		return ptr;
+	}
+
+	// Removed entries right before an empty slot are in no lookup's way, make them empty again.
+	//  Owner only: it is the only one filling slots, so the empty slot stays empty meanwhile.
+	static void clear_removed(Table* table, u32 slot) {
+		if (table->entries[(slot + 1) & (Table::capacity - 1)].ptr.load(std::memory_order_relaxed) != nullptr) return;
+
+		FS_FOR(Table::capacity) {
+			void* expected = removed;
+			if (!table->entries[slot].ptr.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed)) return;
+			slot = (slot - 1) & (Table::capacity - 1);
+		}
+	}
+
+	static bool remove(Table* table, void* ptr, u64& size, Tag& tag) {
+		u32 slot = slot_of(ptr);
+		FS_FOR(Table::max_probe) {
+			auto& e = table->entries[slot];
+			void* current = e.ptr.load(std::memory_order_acquire);
+			if (current == nullptr) return false;
+			if (current == ptr) {
+				size = e.size.load(std::memory_order_relaxed);
+				tag  = (Tag)e.tag.load(std::memory_order_relaxed);
+				if (!e.ptr.compare_exchange_strong(current, removed, std::memory_order_acq_rel)) return false;
+				table->live.fetch_sub(1, std::memory_order_relaxed);
+				if (table == thread_table) clear_removed(table, slot);
+				return true;
+			}
+			slot = (slot + 1) & (Table::capacity - 1);
+		}
+		return false;
+	}
+
+	void tracked_free(void* ptr) {
+		if (!ptr) return;
+
+		// most memory is freed by the thread that allocated it
+		u64 size;
+		Tag tag;
+		bool found = thread_table && remove(thread_table, ptr, size, tag);
+		for (auto table = tables.load(std::memory_order_acquire); table && !found; table = table->next) {
+			if (table != thread_table) found = remove(table, ptr, size, tag);
+		}
+
+		if (found) {
+			counters[tag].live_bytes.fetch_sub(size, std::memory_order_relaxed);
+			counters[tag].live_count.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		FISSION_UNTRACKED_FREE(ptr);
+	}
+
+	Tag_Stats tag_stats(Tag tag) {
+		auto& c = counters[tag];
+		return Tag_Stats{
+			.live_bytes  = c.live_bytes .load(std::memory_order_relaxed),
+			.peak_bytes  = c.peak_bytes .load(std::memory_order_relaxed),
+			.live_count  = c.live_count .load(std::memory_order_relaxed),
+			.total_count = c.total_count.load(std::memory_order_relaxed),
+		};
+	}
+
+	u64 report_leaks() {
+		static constexpr u64 max_printed = 32;
+
+		u64 leaks = 0, bytes = 0, untracked = 0;
+		for (auto table = tables.load(std::memory_order_acquire); table; table = table->next) {
+			untracked += table->untracked.load(std::memory_order_relaxed);
+			for (auto&& e : table->entries) {
+				void* ptr = e.ptr.load(std::memory_order_acquire);
+				if (ptr == nullptr || ptr == removed) continue;
+
+				auto tag = (Tag)e.tag.load(std::memory_order_relaxed);
+				if (tag == tag_process) continue;
+
+				u64 size = e.size.load(std::memory_order_relaxed);
+				if (leaks++ < max_printed) {
+					FS_debug_printf("leak: %llu bytes at %p [%s] stack %08x\n",
+						(unsigned long long)size, ptr, tag_names[tag], e.stack.load(std::memory_order_relaxed));
+				}
+				bytes += size;
+			}
+		}
+
+		if (leaks > max_printed) FS_debug_printf("leak: ... %llu more\n", (unsigned long long)(leaks - max_printed));
+		if (leaks)               FS_debug_printf("%llu allocations leaked, %llu bytes\n", (unsigned long long)leaks, (unsigned long long)bytes);
+		if (untracked)           FS_debug_printf("%llu allocations were not tracked (no room in the table)\n", (unsigned long long)untracked);
+		return leaks;
+	}
+}
+
+__FISSION_END__
+
+#endif // FISSION_TRACK_ALLOCATIONS
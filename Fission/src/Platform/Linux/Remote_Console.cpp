@@ -0,0 +1,212 @@
+#include <Fission/Core/Remote_Console.hh>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <atomic>
+#include <thread>
+
+__FISSION_BEGIN__
+
+struct Remote_Server {
+	struct Client {
+		int         fd;
+		u32         id;
+		std::string in;  // partial line
+		std::string out; // waiting to be sent
+	};
+
+	// a client that never reads is not worth keeping around
+	static constexpr size_t max_pending_output = FS_MEGABYTES(1);
+
+	// same for one that never ends its line
+	static constexpr size_t max_line = FS_KILOBYTES(64);
+
+	Remote_Console*     console;
+	std::string         path;
+	int                 listen_fd;
+	int                 wake_pipe[2];
+	std::atomic<bool>   stop = false;
+	std::thread         thread;
+	std::vector<Client> clients;
+	u32                 next_id = 1;
+
+	void main();
+	bool receive(Client& client);
+	bool flush(Client& client);
+};
+
+bool Remote_Console::start(string _path) {
+	stop();
+
+	sockaddr_un addr = {};
+	addr.sun_family = AF_UNIX;
+	if (_path.count >= sizeof(addr.sun_path)) return false;
+	memcpy(addr.sun_path, _path.data, _path.count);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (fd < 0) return false;
+
+	// socket left behind from a previous run
+	unlink(addr.sun_path);
+
+	if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 4) < 0) {
+		close(fd);
+		return false;
+	}
+
+	int wake_pipe[2];
+	if (pipe2(wake_pipe, O_NONBLOCK | O_CLOEXEC) < 0) {
+		close(fd);
+		unlink(addr.sun_path);
+		return false;
+	}
+
+	server = new Remote_Server;
+	server->console      = this;
+	server->path         = addr.sun_path;
+	server->listen_fd    = fd;
+	server->wake_pipe[0] = wake_pipe[0];
+	server->wake_pipe[1] = wake_pipe[1];
+	server->thread       = std::thread(&Remote_Server::main, server);
+	return true;
+}
+
+void Remote_Console::stop() {
+	if (!server) return;
+
+	server->stop.store(true, std::memory_order_release);
+	wake();
+	server->thread.join();
+
+	for (auto&& client : server->clients) close(client.fd);
+	close(server->listen_fd);
+	close(server->wake_pipe[0]);
+	close(server->wake_pipe[1]);
+	unlink(server->path.c_str());
+
+	delete server;
+	server = nullptr;
+
+	subscriptions.clear();
+	requests.clear();
+	responses.clear();
+}
+
+void Remote_Console::wake() {
+	char c = 1;
+	(void)::write(server->wake_pipe[1], &c, 1);
+}
+
+// returns false when the client is gone
+bool Remote_Server::receive(Client& client) {
+	char buffer[4096];
+	for (;;) {
+		ssize_t n = read(client.fd, buffer, sizeof(buffer));
+		if (n == 0) return false;
+		if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+		client.in.append(buffer, n);
+
+		// every complete line is a request
+		size_t begin = 0, end;
+		while ((end = client.in.find('\n', begin)) != std::string::npos) {
+			size_t count = end - begin;
+			if (count && client.in[end - 1] == '\r') --count;
+
+			if (count) {
+				std::scoped_lock lock{console->mutex};
+				console->requests.emplace_back(Remote_Console::Request{
+					.client       = client.id,
+					.disconnected = false,
+					.command      = client.in.substr(begin, count),
+				});
+			}
+			begin = end + 1;
+		}
+		client.in.erase(0, begin);
+
+		if (client.in.size() > max_line) return false;
+	}
+}
+
+// returns false when the client is gone
+bool Remote_Server::flush(Client& client) {
+	while (!client.out.empty()) {
+		ssize_t n = send(client.fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+			return false;
+		}
+		client.out.erase(0, n);
+	}
+	return client.out.size() <= max_pending_output;
+}
+
+void Remote_Server::main() {
+	std::vector<pollfd> fds;
+
+	while (!stop.load(std::memory_order_acquire)) {
+		fds.clear();
+		fds.emplace_back(pollfd{.fd = listen_fd,    .events = POLLIN});
+		fds.emplace_back(pollfd{.fd = wake_pipe[0], .events = POLLIN});
+		for (auto&& client : clients) {
+			short events = POLLIN;
+			if (!client.out.empty()) events |= POLLOUT;
+			fds.emplace_back(pollfd{.fd = client.fd, .events = events});
+		}
+
+		if (poll(fds.data(), (nfds_t)fds.size(), -1) < 0) {
+			if (errno == EINTR) continue;
+			break;
+		}
+
+		// responses from the console thread
+		if (fds[1].revents & POLLIN) {
+			char temp[64];
+			while (read(wake_pipe[0], temp, sizeof(temp)) > 0);
+
+			std::scoped_lock lock{console->mutex};
+			for (auto&& response : console->responses) {
+				for (auto&& client : clients) {
+					if (client.id == response.client) {
+						client.out += response.text;
+						break;
+					}
+				}
+			}
+			console->responses.clear();
+		}
+
+		// backwards, so clients can be removed
+		for (size_t i = clients.size(); i-- > 0;) {
+			auto& client = clients[i];
+			auto  revents = fds[2 + i].revents;
+
+			bool alive = !(revents & (POLLERR | POLLNVAL));
+			if (alive && (revents & (POLLIN | POLLHUP))) alive = receive(client);
+			if (alive) alive = flush(client);
+
+			if (!alive) {
+				close(client.fd);
+				{
+					std::scoped_lock lock{console->mutex};
+					console->requests.emplace_back(Remote_Console::Request{.client = client.id, .disconnected = true});
+				}
+				clients.erase(clients.begin() + i);
+			}
+		}
+
+		if (fds[0].revents & POLLIN) {
+			int fd;
+			while ((fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+				clients.emplace_back(Client{.fd = fd, .id = next_id++});
+			}
+		}
+	}
+}
+
+__FISSION_END__
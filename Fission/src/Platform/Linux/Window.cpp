@@ -192,6 +192,7 @@ void Window::set_using_mouse_deltas(bool use) {}
 
 Window::~Window() {
     printf("called window destructor\n");
+    if (!_connection) return; // headless, never created
     _thread.join();
     xcb_destroy_window(_connection, _id);
     xcb_disconnect(_connection);
@@ -0,0 +1,15 @@
+#include <Fission/Core/Remote_Console.hh>
+#include <Fission/Core/Console.hh>
+
+__FISSION_BEGIN__
+
+// The remote console is Linux only, see Remote_Console.hh
+bool Remote_Console::start(string path) {
+	console::printf(colors::Red, "remote console not supported on this platform, ignoring \"%.*s\"\n", (int)path.count, path.data);
+	return false;
+}
+
+void Remote_Console::stop() {}
+void Remote_Console::wake() {}
+
+__FISSION_END__
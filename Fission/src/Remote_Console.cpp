@@ -0,0 +1,123 @@
+#include <Fission/Core/Engine.hh>
+#include <Fission/Core/Console.hh>
+
+extern fs::Engine engine;
+
+#define ESCAPE 0x1b
+
+__FISSION_BEGIN__
+
+static bool starts_with(string s, string prefix) {
+	return s.count >= prefix.count && memcmp(s.data, prefix.data, prefix.count) == 0;
+}
+
+void Remote_Console::send(u32 client, string text) {
+	std::string out;
+	out.reserve(text.count);
+
+	// color codes mean nothing outside of the console
+	u32  skip = 0;
+	bool using_color = false;
+	FS_FOR(text.count) {
+		c8 c = text.data[i];
+		if (skip) { --skip; continue; }
+		if (c == ESCAPE) {
+			if (!using_color) skip = 3;
+			using_color = !using_color;
+			continue;
+		}
+		out.push_back((char)c);
+	}
+
+	outgoing.emplace_back(Response{.client = client, .text = std::move(out)});
+}
+
+void Remote_Console::reply(u32 client, string text) {
+	std::string out{text.str()};
+	out.push_back('\0');
+	send(client, FS_str_std(out));
+}
+
+void Remote_Console::subscribe(u32 client, string args, bool enable) {
+	u32 counters = 0;
+	     if (args == "frame_time_ms") counters = frame_time_ms;
+	else if (args == "cpu_time_ms")   counters = cpu_time_ms;
+	else if (args == "all")           counters = ~0u;
+	else {
+		reply(client, FS_str("unknown counter\n"));
+		return;
+	}
+
+	auto it = subscriptions.begin();
+	while (it != subscriptions.end() && it->client != client) ++it;
+
+	if (it == subscriptions.end()) {
+		if (enable) subscriptions.emplace_back(Subscription{client, counters});
+	}
+	else {
+		if (enable) it->counters |=  counters;
+		else        it->counters &=~ counters;
+		if (it->counters == 0) subscriptions.erase(it);
+	}
+
+	reply(client, FS_str("ok\n"));
+}
+
+void Remote_Console::update(double dt) {
+	if (!server) return;
+
+	{
+		std::scoped_lock lock{mutex};
+		std::swap(pending, requests);
+	}
+
+	for (auto&& request : pending) {
+		if (request.disconnected) {
+			std::erase_if(subscriptions, [&](Subscription const& s) { return s.client == request.client; });
+			continue;
+		}
+
+		auto command = FS_str_std(request.command);
+
+		if (starts_with(command, FS_str("subscribe "))) {
+			subscribe(request.client, command.substr(10), true);
+			continue;
+		}
+		if (starts_with(command, FS_str("unsubscribe "))) {
+			subscribe(request.client, command.substr(12), false);
+			continue;
+		}
+
+		// still show what is going on in the console
+		console::print(FS_str("remote> "), colors::DimGray);
+		console::println(command);
+		u64 echo_line = engine.console_layer.buffer.end_line - 2;
+
+		std::string output;
+		engine.console_layer.capture = &output;
+		console::execute_echoed(command, echo_line);
+		engine.console_layer.capture = nullptr;
+
+		reply(request.client, FS_str_std(output));
+	}
+	pending.clear();
+
+	char temp[64];
+	for (auto&& s : subscriptions) {
+		if (s.counters & frame_time_ms)
+			send(s.client, "@frame_time_ms %.4f\n"_fmt(temp, dt * 1000.0));
+		if (s.counters & cpu_time_ms)
+			send(s.client, "@cpu_time_ms %.4f\n"_fmt(temp, engine.debug_layer.cpu_time * 1000.0f));
+	}
+
+	if (outgoing.empty()) return;
+
+	{
+		std::scoped_lock lock{mutex};
+		for (auto&& response : outgoing) responses.emplace_back(std::move(response));
+	}
+	outgoing.clear();
+	wake();
+}
+
+__FISSION_END__
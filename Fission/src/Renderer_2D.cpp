@@ -24,7 +24,8 @@ void Renderer_2D::create(Graphics* gfx, VkRenderPass render_pass, Transform_2D_L
 	max_vertex_count = _r2d_max_count;
 	max_index_count = _r2d_max_count * 2;
 
-	bump_allocator allocator{max_vertex_count * sizeof(vertex) + max_index_count * sizeof(u16)};
+	u64 const size = max_vertex_count * sizeof(vertex) + max_index_count * sizeof(u16);
+	bump_allocator allocator{FISSION_TAGGED_ALLOC(size, renderer), size};
 	vertex_data = allocator.alloc<vertex>(max_vertex_count);
 	index_data  = allocator.alloc<u16>(max_index_count);
 	allocator.release();
@@ -56,6 +57,7 @@ void Renderer_2D::end_render(Render_Context const* ctx) {
 	if (d.total_vtx_count) {
 		auto& fd = frame_data[ctx->frame];
 		fd.set_data(ctx->gfx, vertex_data, index_data, d.total_vtx_count, d.total_idx_count);
+		if (r2d_capture::writer) r2d_capture::arrays(r2d_capture::solid, vertex_data, sizeof(vertex), d.total_vtx_count, index_data, d.total_idx_count);
 //		engine.debug_layer.add("v: %u, i: %u", d.total_vtx_count, d.total_idx_count);
 		d.reset();
 	}
@@ -82,7 +84,8 @@ void Textured_Renderer_2D::create(
 	max_vertex_count = _r2d_max_count;
 	max_index_count = _r2d_max_count * 2;
 	
-	bump_allocator allocator{max_vertex_count * sizeof(vertex) + max_index_count * sizeof(u16)};
+	u64 const size = max_vertex_count * sizeof(vertex) + max_index_count * sizeof(u16);
+	bump_allocator allocator{FISSION_TAGGED_ALLOC(size, renderer), size};
 	vertex_data = allocator.alloc<vertex>(max_vertex_count);
 	index_data  = allocator.alloc<u16>(max_index_count);
 	allocator.release();
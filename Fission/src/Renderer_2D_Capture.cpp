@@ -0,0 +1,367 @@
+#include <Fission/Core/Renderer_2D_Capture.hh>
+#include <Fission/Core/Engine.hh>
+#include <Fission/Core/Console.hh>
+#include <Fission/Core/Frame_Stats.hh>
+#include <Fission/Base/Time.hpp>
+#include <cstdio>
+#include <vector>
+
+extern fs::Engine engine;
+
+__FISSION_BEGIN__
+
+namespace r2d_capture {
+	struct Writer {
+		FILE*             file;
+		std::string       filename;
+		u32               frames_left;
+		u32               frames = 0;
+		bool              discard_frame = true; // started part way through a frame
+
+		Frame_Header      header = {};
+		std::vector<Draw> draws;
+		std::vector<u8>   vertices[2];
+		std::vector<u16>  indices[2];
+	};
+
+	Writer* writer = nullptr;
+
+	static constexpr u32 vertex_sizes[2] = { sizeof(Renderer_2D::vertex), sizeof(Textured_Renderer_2D::vertex) };
+
+	bool start(string filename, u32 max_frames) {
+		stop();
+
+		auto name = std::string(filename.str());
+		FILE* file = fopen(name.c_str(), "wb");
+		if (!file) return false;
+
+		// frames are big, write them in as few calls as possible
+		setvbuf(file, nullptr, _IOFBF, FS_MEGABYTES(1));
+
+		u32 header[] = {
+			version,
+			engine.graphics.sc_extent.width, engine.graphics.sc_extent.height,
+			vertex_sizes[0], vertex_sizes[1],
+		};
+		if (fwrite("FR2D", 1, 4, file) != 4 || fwrite(header, sizeof(header), 1, file) != 1) {
+			fclose(file);
+			return false;
+		}
+
+		writer = new Writer{.file = file, .filename = std::move(name), .frames_left = max(max_frames, 1u)};
+		return true;
+	}
+
+	void stop() {
+		if (!writer) return;
+
+		// the last frames are still buffered, this can fail too
+		if (fclose(writer->file) != 0)
+			console::printf(colors::Red, "capture: writing %s failed, the last frames are missing\n", writer->filename.c_str());
+		console::printf(colors::White, "captured %u frames to %s\n", writer->frames, writer->filename.c_str());
+
+		delete writer;
+		writer = nullptr;
+	}
+
+	void draw(Renderer renderer, bool custom_pipeline, Font* font, u32 idx_offset, u32 idx_count, u32 vtx_offset) {
+		Font_Id id = font_none;
+		if (renderer == textured) {
+			if      (font == &engine.fonts.debug)   id = font_debug;
+			else if (font == &engine.fonts.console) id = font_console;
+			else                                    id = font_other;
+		}
+		writer->draws.emplace_back(Draw{
+			.renderer        = renderer,
+			.custom_pipeline = custom_pipeline,
+			.font            = id,
+			.idx_offset      = idx_offset,
+			.idx_count       = idx_count,
+			.vtx_offset      = vtx_offset,
+		});
+	}
+
+	void arrays(Renderer renderer, void const* vertices, u32 vertex_size, u32 vtx_count, u16 const* indices, u32 idx_count) {
+		auto& w = *writer;
+		w.header.vtx_count[renderer] = vtx_count;
+		w.header.idx_count[renderer] = idx_count;
+		w.vertices[renderer].assign((u8 const*)vertices, (u8 const*)vertices + u64(vertex_size) * vtx_count);
+		w.indices [renderer].assign(indices, indices + idx_count);
+	}
+
+	void end_frame() {
+		auto& w = *writer;
+
+		if (w.discard_frame) w.discard_frame = false;
+		else {
+			w.header.draw_count = (u32)w.draws.size();
+
+			u32 size = sizeof(Frame_Header) + w.header.draw_count * sizeof(Draw);
+			FS_FOR(2) size += u32(w.vertices[i].size() + w.indices[i].size() * sizeof(u16));
+
+			// keeps every frame header 4 byte aligned when the file is read in whole
+			u32 const padding = (4 - size % 4) % 4;
+			size += padding;
+
+			bool ok = fwrite(&size, sizeof(size), 1, w.file) == 1
+				&& fwrite(&w.header, sizeof(w.header), 1, w.file) == 1
+				&& fwrite(w.draws.data(), sizeof(Draw), w.draws.size(), w.file) == w.draws.size();
+			for (u32 i = 0; ok && i < 2; ++i) {
+				ok = fwrite(w.vertices[i].data(), 1, w.vertices[i].size(), w.file) == w.vertices[i].size()
+					&& fwrite(w.indices[i].data(), sizeof(u16), w.indices[i].size(), w.file) == w.indices[i].size();
+			}
+			u32 zero = 0;
+			ok = ok && fwrite(&zero, 1, padding, w.file) == padding;
+
+			// disk full, what made it out is readable up to the last whole frame
+			if (!ok) {
+				console::printf(colors::Red, "capture: writing %s failed, stopping\n", w.filename.c_str());
+				return stop();
+			}
+			++w.frames;
+		}
+
+		w.header = {};
+		w.draws.clear();
+		FS_FOR(2) {
+			w.vertices[i].clear();
+			w.indices[i].clear();
+		}
+
+		if (w.frames == w.frames_left) stop();
+	}
+
+	struct Replay_Scene : public Scene {
+		struct Frame {
+			Frame_Header const* header;
+			Draw const*         draws;
+			u8 const*           vertices[2];
+			u16 const*          indices[2];
+		};
+
+		std::vector<u8>    data;
+		std::vector<Frame> frames;
+		Render_Pass        rp;
+
+		u32  loops     = 1;
+		bool quit      = false;
+		u32  next      = 0; // next frame to draw
+		u32  loop      = 0;
+
+		Frame_Stats stats;       // time between frames
+		double      cpu_seconds = 0.0; // spent in here, copying and recording draws
+		s64         pass_start  = 0;
+
+		VkPresentModeKHR present_mode;
+		bool             fps_limiter;
+		bool             ready = false;
+
+		bool load(string filename);
+		void on_update(double dt, std::vector<Event> const& events, Render_Context* ctx) override;
+		void report();
+
+		~Replay_Scene() override {
+			if (!ready) return;
+			vkDeviceWaitIdle(engine.graphics.device);
+			rp.destroy();
+			stats.destroy();
+
+			// back to how it was
+			if (fps_limiter) engine.flags |= engine.fFPS_Limiter_Enable;
+			if (engine.graphics.sc_present_mode != present_mode) {
+				engine.graphics.sc_present_mode = present_mode;
+				engine.flags |= engine.fGraphics_Recreate_Swap_Chain;
+			}
+		}
+	};
+
+	bool Replay_Scene::load(string filename) {
+		auto name = std::string(filename.str());
+		FILE* file = fopen(name.c_str(), "rb");
+		if (!file) {
+			console::printf(colors::Red, "r2d_replay: could not open \"%s\"\n", name.c_str());
+			return false;
+		}
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		data.resize(size > 0 ? size : 0);
+		data.resize(fread(data.data(), 1, data.size(), file));
+		fclose(file);
+
+		u32 header[5];
+		if (data.size() < 4 + sizeof(header) || memcmp(data.data(), "FR2D", 4) != 0) {
+			console::printf(colors::Red, "r2d_replay: \"%s\" is not a capture\n", name.c_str());
+			return false;
+		}
+		memcpy(header, data.data() + 4, sizeof(header));
+		if (header[0] != version || header[3] != vertex_sizes[0] || header[4] != vertex_sizes[1]) {
+			console::printf(colors::Red, "r2d_replay: \"%s\" was captured by a different version\n", name.c_str());
+			return false;
+		}
+		if (header[1] != engine.graphics.sc_extent.width || header[2] != engine.graphics.sc_extent.height) {
+			console::printf(colors::Yellow, "r2d_replay: captured at %ux%u, drawing at %ux%u\n",
+				header[1], header[2], engine.graphics.sc_extent.width, engine.graphics.sc_extent.height);
+		}
+
+		// index every frame, a capture cut short only loses its last frame
+		u64 cursor = 4 + sizeof(header);
+		while (cursor + sizeof(u32) + sizeof(Frame_Header) <= data.size()) {
+			u32 frame_size;
+			memcpy(&frame_size, data.data() + cursor, sizeof(u32));
+			cursor += sizeof(u32);
+			if (cursor + frame_size > data.size()) break;
+
+			Frame f;
+			auto base = data.data() + cursor;
+			f.header = (Frame_Header const*)base;
+
+			u64 offset = sizeof(Frame_Header);
+			f.draws = (Draw const*)(base + offset);
+			offset += u64(f.header->draw_count) * sizeof(Draw);
+			FS_FOR(2) {
+				f.vertices[i] = base + offset;              offset += u64(f.header->vtx_count[i]) * vertex_sizes[i];
+				f.indices [i] = (u16 const*)(base + offset); offset += u64(f.header->idx_count[i]) * sizeof(u16);
+			}
+
+			bool fits = offset <= frame_size && frame_size - offset < 4
+				&& f.header->vtx_count[solid]    <= engine.renderer_2d.max_vertex_count
+				&& f.header->idx_count[solid]    <= engine.renderer_2d.max_index_count
+				&& f.header->vtx_count[textured] <= engine.textured_renderer_2d.max_vertex_count
+				&& f.header->idx_count[textured] <= engine.textured_renderer_2d.max_index_count;
+
+			// draws have to stay inside the arrays, the GPU does not check
+			for (u32 i = 0; fits && i < f.header->draw_count; ++i) {
+				Draw draw;
+				memcpy(&draw, f.draws + i, sizeof(Draw));
+				fits = draw.renderer <= textured
+					&& u64(draw.idx_offset) + draw.idx_count <= f.header->idx_count[draw.renderer]
+					&& draw.vtx_offset <= f.header->vtx_count[draw.renderer];
+
+				// and so do the vertices its indices point at
+				u32 const vtx_count = fits ? f.header->vtx_count[draw.renderer] - draw.vtx_offset : 0;
+				u16 const* indices  = f.indices[draw.renderer] + draw.idx_offset;
+				for (u32 k = 0; fits && k < draw.idx_count; ++k) {
+					fits = indices[k] < vtx_count;
+				}
+			}
+			if (!fits) {
+				console::printf(colors::Red, "r2d_replay: frame %u is broken, stopping there\n", (u32)frames.size());
+				break;
+			}
+
+			frames.emplace_back(f);
+			cursor += frame_size;
+		}
+
+		if (frames.empty()) {
+			console::printf(colors::Red, "r2d_replay: no frames in \"%s\"\n", name.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	// Arrays in the file are not aligned for the renderer, copy them over
+	static void copy_arrays(auto& renderer, Replay_Scene::Frame const& f, Renderer r) {
+		memcpy(renderer.vertex_data, f.vertices[r], u64(f.header->vtx_count[r]) * sizeof(*renderer.vertex_data));
+		memcpy(renderer.index_data,  f.indices[r],  u64(f.header->idx_count[r]) * sizeof(u16));
+		renderer.d.total_vtx_count = f.header->vtx_count[r];
+		renderer.d.total_idx_count = f.header->idx_count[r];
+	}
+
+	void Replay_Scene::on_update(double dt, std::vector<Event> const& events, Render_Context* ctx) {
+		if (next == 0 && loop == 0) pass_start = timestamp();
+		else stats.add((float)dt);
+
+		s64 start = timestamp();
+		auto const& f = frames[next];
+
+		auto& r2d  = engine.renderer_2d;
+		auto& tr2d = engine.textured_renderer_2d;
+		copy_arrays(r2d,  f, solid);
+		copy_arrays(tr2d, f, textured);
+
+		rp.begin(ctx, colors::Black);
+		engine.bind_font(ctx->command_buffer, &engine.fonts.debug); // transform for both renderers
+		u8 bound_font = font_debug;
+
+		FS_FOR(f.header->draw_count) {
+			auto const& draw = f.draws[i];
+			auto& d = (draw.renderer == solid) ? r2d.d : tr2d.d;
+			d.idx_offset = draw.idx_offset;
+			d.idx_count  = draw.idx_count;
+			d.vtx_offset = draw.vtx_offset;
+
+			if (draw.renderer == solid) r2d.draw(*ctx);
+			else {
+				u8 font = (draw.font == font_console) ? font_console : font_debug;
+				if (font != bound_font) {
+					engine.bind_font(ctx->command_buffer, font == font_console ? &engine.fonts.console : &engine.fonts.debug);
+					bound_font = font;
+				}
+				tr2d.draw(*ctx);
+			}
+		}
+		rp.end(ctx);
+
+		cpu_seconds += seconds_elasped(start, timestamp());
+
+		if (++next == frames.size()) {
+			next = 0;
+			if (++loop == loops) {
+				report();
+				loop = 0;
+				stats.reset();
+				cpu_seconds = 0.0;
+				if (quit) engine.flags &=~ engine.fRunning;
+			}
+		}
+	}
+
+	void Replay_Scene::report() {
+		u64    count   = u64(frames.size()) * loops;
+		double seconds = seconds_elasped(pass_start, timestamp());
+
+		console::printf(colors::White, "r2d_replay: %llu frames in %.3f s, %.1f fps\n",
+			(unsigned long long)count, seconds, double(count) / seconds);
+		console::printf(colors::White, "  frame: p50 %.3f  p95 %.3f  p99 %.3f  max %.3f ms\n",
+			stats.quantile(0.50f) * 1000.0f, stats.quantile(0.95f) * 1000.0f,
+			stats.quantile(0.99f) * 1000.0f, stats.maximum() * 1000.0f);
+		console::printf(colors::White, "  replay cpu: %.4f ms per frame\n", cpu_seconds * 1000.0 / double(count));
+	}
+
+	Scene* create_replay_scene(Scene_Key const& key) {
+		auto scene = new Replay_Scene;
+
+		string file = {};
+		for (auto [name, value] : key) {
+			if (name == "file"  && value.type == Scene_Key::Value::String) file = value.v_string;
+			if (name == "loops" && value.type == Scene_Key::Value::Int64)  scene->loops = (u32)max(value.v_s64, (s64)1);
+			if (name == "quit") scene->quit = true;
+		}
+
+		if (!scene->load(file)) {
+			delete scene;
+			return nullptr;
+		}
+
+		scene->rp.name = "r2d replay";
+		scene->rp.create(VK_SAMPLE_COUNT_1_BIT, true);
+		scene->stats.create((u32)min(u64(scene->frames.size()) * scene->loops, u64(1) << 16));
+		scene->ready = true;
+
+		// as fast as it goes
+		scene->present_mode = engine.graphics.sc_present_mode;
+		scene->fps_limiter  = engine.flags & engine.fFPS_Limiter_Enable;
+		engine.flags &=~ engine.fFPS_Limiter_Enable;
+		if (engine.graphics.sc_present_mode != VK_PRESENT_MODE_IMMEDIATE_KHR) {
+			engine.graphics.sc_present_mode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+			engine.flags |= engine.fGraphics_Recreate_Swap_Chain;
+		}
+
+		console::printf(colors::White, "r2d_replay: %u frames, %u loops\n", (u32)scene->frames.size(), scene->loops);
+		return scene;
+	}
+}
+
+__FISSION_END__
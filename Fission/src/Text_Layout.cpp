@@ -0,0 +1,128 @@
+#include <Fission/Core/Text_Layout.hh>
+
+#define ESCAPE 0x1b
+
+__FISSION_BEGIN__
+
+// Breaks `text` into lines starting at `start`, calling `emit(Text_Line const&)` for every line.
+// The last line emitted is the "open" line (everything after the last line break).
+template <typename Emit>
+static void break_lines(Font* font, string text, u32 start, Text_Color_State state, float max_width, u32 flags, Emit&& emit) {
+	Glyph const* glyphs[glyph_batch_size];
+	float const tab_width = font->lookup(' ')->advance * 4.0f;
+	bool  const wrap = max_width > 0.0f;
+
+	Text_Line line = {.offset = start, .count = 0, .width = 0.0f, .color = state.color, .using_color = state.using_color};
+	float width = 0.0f;
+
+	// last place we are allowed to break the line (after a space),
+	//  `break_at == line.offset` means there is no such place.
+	u32              break_at    = start;
+	float            break_width = 0.0f; // width of the line before that space
+	float            after_break = 0.0f; // width of everything after that space
+	Text_Color_State break_state = state;
+
+	auto end_line = [&](u32 end, float line_width, u32 next, Text_Color_State next_state) {
+		line.count = end - line.offset;
+		line.width = line_width;
+		emit(line);
+		line = {.offset = next, .count = 0, .width = 0.0f, .color = next_state.color, .using_color = next_state.using_color};
+		break_at = next;
+		after_break = 0.0f;
+	};
+
+	u32 skip = 0; // bytes of a color code left to skip
+	for (u64 base = start; base < text.count; base += glyph_batch_size) {
+		auto chunk = text.substr(base, glyph_batch_size);
+		font->lookup_many(chunk, glyphs);
+
+		FS_FOR(chunk.count) {
+			u32 index = u32(base + i);
+			c8  c     = chunk.data[i];
+
+			if (skip) { --skip; continue; }
+
+			if ((flags & text_layout::console_colors) && c == ESCAPE) {
+				if (state.using_color) {
+					state.color = colors::White;
+				}
+				else {
+					skip = (u32)min(text.count - index - 1, 3);
+					if (skip == 3) {
+						state.color = rgb8(text.data[index + 1], text.data[index + 2], text.data[index + 3]);
+					}
+				}
+				state.using_color = !state.using_color;
+				continue;
+			}
+
+			if (c == '\n') {
+				end_line(index, width, index + 1, state);
+				width = 0.0f;
+				continue;
+			}
+
+			float advance = (c == '\t') ? tab_width : glyphs[i]->advance;
+
+			if (wrap && width + advance > max_width && index > line.offset) {
+				// wrap at the last space
+				if (break_at > line.offset) {
+					float carried = after_break;
+					end_line(break_at - 1, break_width, break_at, break_state);
+					width = carried;
+				}
+				// word is still too long, break in the middle of it
+				if (width + advance > max_width && index > line.offset) {
+					end_line(index, width, index, state);
+					width = 0.0f;
+				}
+			}
+
+			width += advance;
+
+			if (c == ' ') {
+				break_at    = index + 1;
+				break_width = width - advance;
+				break_state = state;
+				after_break = 0.0f;
+			}
+			else after_break += advance;
+		}
+	}
+
+	line.count = u32(text.count) - line.offset;
+	line.width = width;
+	emit(line);
+}
+
+v2f32 measure_text(Font* font, string text, float max_width, u32 flags, Text_Color_State start) {
+	float width = 0.0f;
+	u32   count = 0;
+	break_lines(font, text, 0, start, max_width, flags, [&](Text_Line const& line) {
+		width = std::max(width, line.width);
+		++count;
+	});
+	return {width, font->height * (float)count};
+}
+
+void Text_Layout::reset(Font* _font, float _max_width, u32 _flags) {
+	font       = _font;
+	max_width  = _max_width;
+	flags      = _flags;
+	lines.clear();
+}
+
+void Text_Layout::layout(string text, Text_Color_State start) {
+	lines.clear();
+	break_lines(font, text, 0, start, max_width, flags, [this](Text_Line const& line) {
+		lines.emplace_back(line);
+	});
+}
+
+v2f32 Text_Layout::size() const {
+	float width = 0.0f;
+	for (auto&& line : lines) width = std::max(width, line.width);
+	return {width, font->height * (float)lines.size()};
+}
+
+__FISSION_END__
@@ -0,0 +1,101 @@
+#define PROFILER_IMPLEMENTATION
+#include <Fission/Core/Trace.hh>
+#include <Fission/Core/Console.hh>
+#include <string>
+#include <thread>
+#include <atomic>
+
+__FISSION_BEGIN__
+
+namespace trace {
+	profiler::Session* session = nullptr;
+
+	static profiler::Session recording;
+	static std::string       pending_file;
+	static double            pending_ring_seconds = 0.0; // 0 -> streaming to `pending_file`
+	static bool              pending_start = false;
+	static bool              pending_stop  = false;
+
+	static std::thread       dump_thread;
+	static std::atomic<bool> dumping = false;
+	static bool              ring    = false;
+
+	// per thread, only has to hold what is recorded between two flushes
+	static constexpr int events_per_thread = 1 << 16;
+
+	void start(string filename) {
+		pending_file  = std::string(filename.str());
+		pending_ring_seconds = 0.0;
+		pending_start = true;
+		pending_stop  = false;
+	}
+
+	void start_ring(double seconds) {
+		pending_ring_seconds = max(seconds, 0.1);
+		pending_start = true;
+		pending_stop  = false;
+	}
+
+	bool dump(string filename) {
+		if (!session || !ring || dumping.load(std::memory_order_acquire)) return false;
+		if (dump_thread.joinable()) dump_thread.join();
+
+		dumping.store(true, std::memory_order_relaxed);
+		dump_thread = std::thread([file = std::string(filename.str())] {
+			recording.save(file.c_str());
+			dumping.store(false, std::memory_order_release);
+		});
+		return true;
+	}
+
+	// a dump reads the session, it has to finish before the session goes away
+	static void end_session() {
+		session = nullptr;
+		if (dump_thread.joinable()) dump_thread.join();
+		recording.uninit();
+		ring = false;
+	}
+
+	void stop() {
+		pending_stop  = true;
+		pending_start = false;
+	}
+
+	void update() {
+		if (pending_stop) {
+			pending_stop = false;
+			if (session) {
+				end_session();
+				console::println(FS_str("trace stopped"));
+			}
+		}
+		if (pending_start) {
+			pending_start = false;
+			if (session) end_session();
+
+			char const* thread_names[] = { "Main Thread", "GPU" };
+
+			if (pending_ring_seconds > 0.0) {
+				recording.init(events_per_thread, profiler::mode_Ring, pending_ring_seconds);
+				recording.name_threads(thread_names, (int)std::size(thread_names));
+				session = &recording;
+				ring    = true;
+				console::printf(colors::White, "tracing the last %.1f seconds\n", pending_ring_seconds);
+				return;
+			}
+
+			recording.init(events_per_thread);
+			recording.name_threads(thread_names, (int)std::size(thread_names));
+
+			if (auto r = recording.start_streaming(pending_file.c_str())) {
+				recording.uninit();
+				console::printf(colors::Red, "failed to start trace \"%s\": %s\n", pending_file.c_str(), profiler::error_str(r));
+				return;
+			}
+			session = &recording;
+			console::printf(colors::White, "tracing to %s\n", pending_file.c_str());
+		}
+	}
+}
+
+__FISSION_END__
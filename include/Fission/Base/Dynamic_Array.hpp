@@ -28,10 +28,8 @@ struct dynamic_array
 	
 	constexpr dynamic_array() = default;
 	
-	dynamic_array(u32 initial_capacity)
-	:	allocated(initial_capacity), count(0), data(nullptr)
-	{
-		data = reinterpret_cast<type*>(FISSION_DEFAULT_ALLOC(initial_capacity * sizeof(type)));
+	dynamic_array(u32 initial_capacity) {
+		reserve(initial_capacity);
 	}
 	
 	void push_back(type const& value) {
@@ -41,13 +39,19 @@ struct dynamic_array
 
 	void reserve(u32 new_capacity) {
 		if (new_capacity <= allocated) return;
-		
-		auto ptr = FISSION_DEFAULT_ALLOC(new_capacity);
+
+		// grow by half at least, `push_back` one at a time would copy everything every time
+		new_capacity = max(new_capacity, allocated + allocated / 2);
+
+		// allocations are a multiple of the alignment, whatever is left over is usable
+		u64 size = (u64(new_capacity) * sizeof(type) + 63) & ~u64(63);
+		auto ptr = FISSION_DEFAULT_ALLOC(size);
 		if (data != nullptr) {
 			memcpy(ptr, data, count * sizeof(type));
 			FISSION_DEFAULT_FREE(data);
 		}
 		data = reinterpret_cast<type*>(ptr);
+		allocated = u32(size / sizeof(type));
 	}
 
 	constexpr type const* begin() const { return data; }
@@ -15,16 +15,70 @@
 #include <cstdlib>
 #include <memory>
 
+// Allocation tracking (premake5 --track-allocations), never in release builds
+#if defined(FISSION_TRACK_ALLOCATIONS) && (defined(FISSION_RELEASE) || defined(FISSION_DIST) || defined(RELEASE) || defined(DIST))
+#	undef FISSION_TRACK_ALLOCATIONS
+#endif
+#if defined(FISSION_TRACK_ALLOCATIONS)
+#	include <atomic>
+#endif
+
 __FISSION_BEGIN__
 
 #if defined(FISSION_PLATFORM_WINDOWS)
-#define FISSION_DEFAULT_ALLOC(Size) ::_aligned_malloc(Size, 64)
-#define FISSION_DEFAULT_FREE(Ptr)   ::_aligned_free(Ptr)
+#define FISSION_UNTRACKED_ALLOC(Size) ::_aligned_malloc(Size, 64)
+#define FISSION_UNTRACKED_FREE(Ptr)   ::_aligned_free(Ptr)
 #elif defined(FISSION_PLATFORM_LINUX)
-#define FISSION_DEFAULT_ALLOC(Size) ::aligned_alloc(64, Size)
-#define FISSION_DEFAULT_FREE(Ptr)   ::free(Ptr)
+#define FISSION_UNTRACKED_ALLOC(Size) ::aligned_alloc(64, Size)
+#define FISSION_UNTRACKED_FREE(Ptr)   ::free(Ptr)
+#endif
+
+#if defined(FISSION_TRACK_ALLOCATIONS)
+namespace memory {
+	// What the memory is for, `process` is memory meant to live until exit (never a leak)
+	enum Tag: u8 {
+		tag_general,
+		tag_renderer,
+		tag_console,
+		tag_font,
+		tag_scene,
+		tag_debug,
+		tag_process,
+		tag_count,
+	};
+	inline constexpr char const* tag_names[tag_count] = {
+		"general", "renderer", "console", "font", "scene", "debug", "process",
+	};
+
+	// live and peak only count allocations that made it into a table (see `report_leaks` for untracked)
+	struct Tag_Stats {
+		u64 live_bytes;
+		u64 peak_bytes;
+		u64 live_count;
+		u64 total_count; // allocations ever made
+	};
+
+	// Hash of the callstack of every allocation, so leaks from the same place
+	//  can be told apart from the rest. Slow, off by default.
+	FISSION_API extern std::atomic<bool> capture_stacks;
+
+	FISSION_API void* tracked_alloc(u64 size, Tag tag);
+	FISSION_API void  tracked_free(void* ptr);
+
+	FISSION_API Tag_Stats tag_stats(Tag tag);
+
+	// Prints every allocation still alive (except `tag_process`), returns how many there were
+	FISSION_API u64 report_leaks();
+}
+#define FISSION_TAGGED_ALLOC(Size, Tag) ::fs::memory::tracked_alloc(Size, ::fs::memory::tag_##Tag)
+#define FISSION_DEFAULT_FREE(Ptr)       ::fs::memory::tracked_free(Ptr)
+#else
+#define FISSION_TAGGED_ALLOC(Size, Tag) FISSION_UNTRACKED_ALLOC(Size)
+#define FISSION_DEFAULT_FREE(Ptr)       FISSION_UNTRACKED_FREE(Ptr)
 #endif
 
+#define FISSION_DEFAULT_ALLOC(Size) FISSION_TAGGED_ALLOC(Size, general)
+
 //! @brief Default Bump Allocator
 struct bump_allocator
 {
@@ -55,6 +109,10 @@ struct bump_allocator
 	bump_allocator(u64 capacity)
 	:	base((u8*)FISSION_DEFAULT_ALLOC(capacity)), capacity(capacity)
 	{}
+	// takes ownership of `memory` (from `FISSION_TAGGED_ALLOC`)
+	bump_allocator(void* memory, u64 capacity)
+	:	base((u8*)memory), capacity(capacity)
+	{}
 
 	void create(u64 capacity) {
 		this->capacity = capacity;
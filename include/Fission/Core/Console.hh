@@ -26,6 +26,26 @@ namespace console_callback {
 using console_callback_proc = decltype(&console_callback::procedure);
 
 namespace console {
+	namespace severity {
+		enum Type: u8 {
+			info    = 0,
+			warning = 1,
+			error   = 2,
+		};
+	}
+
+	// Printing from any thread never blocks. The console thread writes straight into the console,
+	//  other threads go through a 64 KB queue of their own that the console thread empties once a frame:
+	//  - a single message from another thread can be at most 32 KB, longer ones are dropped
+	//    (and counted), the same as messages that do not fit in a full queue;
+	//  - a thread allocates its queue on its first message (or takes over one from a thread
+	//    that has exited). Threads that must not allocate later (audio callbacks) call
+	//    `prepare_thread` first. The console thread never allocates.
+	FISSION_API void prepare_thread();
+
+	// println, but the line is tagged with a severity (see `filter` command)
+	FISSION_API void log(severity::Type severity, string text);
+
 	FISSION_API void println(string text);
 	FISSION_API void println(string text, rgb8 color);
 
@@ -34,6 +54,12 @@ namespace console {
 
 	FISSION_API void clear();
 
+	// run a command as if it was typed in (console thread only)
+	FISSION_API void execute(string command, bool echo = true);
+	// same, but the caller has already written the command to the console, at line `echo_line`
+	//  (`find` leaves that line out of its matches)
+	FISSION_API void execute_echoed(string command, u64 echo_line);
+
 	FISSION_API void register_command(string name, console_callback_proc proc);
 	FISSION_API void unregister_command(string name);
 	
@@ -0,0 +1,74 @@
+/**
+ *	______________              _____
+ *	___  ____/__(_)________________(_)____________
+ *	__  /_   __  /__  ___/_  ___/_  /_  __ \_  __ \
+ *	_  __/   _  / _(__  )_(__  )_  / / /_/ /  / / /
+ *	/_/      /_/  /____/ /____/ /_/  \____//_/ /_/
+ *
+ *
+ * @Author:       lazergenixdev@gmail.com
+ * @Development:  (https://github.com/lazergenixdev/Fission)
+ * @License:      MIT (see end of file)
+ */
+#pragma once
+#include <Fission/config.hpp>
+#include <Fission/Base/String.hpp>
+#include <vector>
+
+__FISSION_BEGIN__
+
+// Runs console commands from a file, one command per line, a few lines every frame.
+//
+// Besides every console command, scripts can use:
+//	# comment
+//	wait <n> frames    (or just `wait <n>`)
+//	wait <x> s
+//
+// `exec` inside a script runs the other script to completion first.
+struct Console_Script {
+	bool load(string path);
+
+	// runs commands until the script waits or ends (console thread, once per frame)
+	void update(double dt);
+
+	inline bool running() const { return !files.empty(); }
+
+	u32 failed_assertions = 0;
+
+private:
+	struct File {
+		std::vector<c8> text;
+		u64             cursor;
+	};
+	bool wait(string args);
+
+	std::vector<File> files;
+	u64               wait_frames  = 0;
+	double            wait_seconds = 0.0;
+};
+
+__FISSION_END__
+
+/**
+ *	MIT License
+ *
+ *	Copyright (c) 2021-2023 lazergenixdev
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
@@ -0,0 +1,102 @@
+/**
+ *	______________              _____
+ *	___  ____/__(_)________________(_)____________
+ *	__  /_   __  /__  ___/_  ___/_  /_  __ \_  __ \
+ *	_  __/   _  / _(__  )_(__  )_  / / /_/ /  / / /
+ *	/_/      /_/  /____/ /____/ /_/  \____//_/ /_/
+ *
+ *
+ * @Author:       lazergenixdev@gmail.com
+ * @Development:  (https://github.com/lazergenixdev/Fission)
+ * @License:      MIT (see end of file)
+ */
+#pragma once
+#include <Fission/config.hpp>
+#include <Fission/Base/String.hpp>
+
+__FISSION_BEGIN__
+
+// Named values tracked over time (see `Debug_Layer::counter` and `Debug_Layer::plot`).
+//
+// Recording only stores into `values`, once per frame every value is copied into
+//  its counter's history and written to the trace as a counter track. Counters are
+//  kept as separate arrays, the history is a single block where every counter's
+//  samples are contiguous, so drawing a graph reads one run of memory.
+struct Counters {
+	static constexpr u32 max_count = 64;
+	static constexpr u32 history   = 128; // samples kept per counter
+
+	enum Kind : u8 {
+		kind_counter, // keeps its value until it is set again
+		kind_plot,    // amount for one frame, adds up and goes back to 0 after every frame
+	};
+
+	u32         count = 0;
+	char const* names [max_count]; // not copied, use string literals
+	Kind        kinds [max_count];
+	float       values[max_count]; // current frame
+	float*      samples = nullptr; // [max_count][history], ring per counter
+	u64         frame   = 0;       // samples recorded so far
+
+	void create();
+	void destroy();
+	void clear();
+
+	// ~0u when there is no room
+	u32 find_or_add(char const* name, Kind kind);
+	// ~0u when not found
+	u32 find(string name) const;
+
+	// `id` is kept by the caller (starts at ~0u), the name is only looked up the first time
+	//  and again after `clear`, otherwise this is one compare
+	inline u32 find_or_add(u32& id, char const* name, Kind kind) {
+		if (id >= count || names[id] != name) id = find_or_add(name, kind);
+		return id;
+	}
+
+	inline void set(u32 id, float value) { if (id < count) values[id] = value; }
+	inline void add(u32 id, float value) { if (id < count) values[id] += value; }
+
+	// Engine only, once at the end of every frame
+	void end_frame();
+
+	// Samples in the history right now
+	inline u32 sample_count() const { return (u32)min(frame, (u64)history); }
+
+	// 0 is the oldest sample
+	inline float sample(u32 id, u32 index) const {
+		u64 first = frame - sample_count();
+		return samples[id * history + (first + index) % history];
+	}
+
+	struct Summary {
+		float last, min, max, mean;
+	};
+	Summary summarize(u32 id) const;
+};
+
+__FISSION_END__
+
+/**
+ *	MIT License
+ *
+ *	Copyright (c) 2021-2023 lazergenixdev
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
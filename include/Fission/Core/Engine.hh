@@ -13,6 +13,8 @@
 #pragma once
 #include <Fission/Core/Window.hh>
 #include <Fission/Core/Graphics.hh>
+#include <Fission/Core/Gpu_Timer.hh>
+#include <Fission/Core/Memory_Stats.hh>
 #include <Fission/Core/Font.hh>
 #include <Fission/Core/Layer.hh>
 #include <Fission/Core/Scene.hh>
@@ -51,6 +53,10 @@ struct Defaults {
 	Window_Mode window_mode      = Windowed;
 	int         display_index    = Display_Index_Automatic;
 	string      config_location  = FS_str(".Fission"); // "app_name"
+	u64         console_history  = FS_MEGABYTES(1);     // bytes of console text to keep around
+	string      console_log_file = {};                  // mirror console output to this file (if not empty)
+	string      remote_console   = {};                  // socket path for the remote console (if not empty, Linux only)
+	bool        headless         = false;               // no window, draws `window_width` x `window_height` offscreen
 };
 
 struct FISSION_API Engine {
@@ -80,6 +86,7 @@ struct FISSION_API Engine {
 	// Members
 	Window               window;
 	Graphics             graphics;
+	Gpu_Timer            gpu_timer;
 
 	// Engine overlay's render pass, expects current
 	//	swap chain image to be in layout: COLOR_ATTACHMENT_OPTIMAL
@@ -92,11 +99,18 @@ struct FISSION_API Engine {
 	Debug_Layer   debug_layer;
 	Console_Layer console_layer;
 
+	Memory_Stats  memory_stats;
+
 	Scene* current_scene;
 		
 	u64 flags = 0;
 	u64 modifier_keys = 0;
 	float fps_limit = 60.0f;
+	int exit_code = 0; // returned from main (`quit` command)
+
+	// Not 0 -> scenes (and console scripts) see exactly this dt every frame,
+	//  so runs can be repeated. The debug layer still gets the real frame time.
+	double fixed_dt = 0.0;
 
 	// Version stuff
 	compressed_version const version;
@@ -132,6 +146,7 @@ struct FISSION_API Engine {
 	void* _ts_base = nullptr;
 	u32   _ts_allocated = 0;
 	u32   _ts_size = 0;
+	u32   _ts_peak = 0; // high-water mark of `_ts_allocated`
 
 	Scene_Key next_scene_key;
 
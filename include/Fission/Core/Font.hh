@@ -27,12 +27,24 @@ struct Glyph {
 };
 
 struct Glyph_Table_Fast {
-	Glyph fallback;
-	Glyph glyphs[127-32]; // store all ascii characters
+	Glyph glyphs[1 + 127-32]; // fallback, then all printable ascii characters
 
-	Glyph const* lookup(u32 u) {
-		if (u < 32 || u > 127) return &fallback;
-		return &glyphs[u - 32];
+	inline Glyph&       fallback()       { return glyphs[0]; }
+	inline Glyph const& fallback() const { return glyphs[0]; }
+
+	Glyph const* lookup(u32 u) const {
+		if (u < 32 || u >= 127) return &glyphs[0];
+		return &glyphs[u - 31];
+	}
+
+	// The fallback is just index 0, so the whole lookup
+	//  becomes one compare and a mask (no branches).
+	void lookup_many(string s, Glyph const** out) const {
+		FS_FOR(s.count) {
+			u32 index = u32(s.data[i]) - 31u;
+			index &= 0u - u32(index - 1u < 95u);
+			out[i] = glyphs + index;
+		}
 	}
 };
 static constexpr int __sizeof_Glyph_Table_Fast = sizeof(Glyph_Table_Fast);
@@ -40,11 +52,33 @@ struct Glyph_Table_Standard {
 
 };
 
+// Max number of glyphs looked up at once by the text functions
+static constexpr u64 glyph_batch_size = 128;
+
+// Max number of horizontal subpixel positions a glyph can be rasterized at
+static constexpr u32 max_subpixel_variants = 4;
+
 struct Font {
 	float height;
 
+	// Subpixel positioning (optional): every glyph is rasterized `subpixel_variants` times,
+	//  each one shifted right by another 1/subpixel_variants of a pixel.
+	//  Glyphs of variant `v` are stored at the same index starting from `subpixel_base[v]`.
+	//  These point into the font itself, fonts that set them must not be copied or moved.
+	u32          subpixel_variants = 1; // 1 -> disabled
+	Glyph const* subpixel_base[max_subpixel_variants] = {};
+
+	// Same glyph, but rasterized at a pen offset of `variant / subpixel_variants` pixels
+	inline Glyph const* subpixel_glyph(Glyph const* glyph, u32 variant) const {
+		return subpixel_base[variant] + (glyph - subpixel_base[0]);
+	}
+
 	// TODO: There will only every be two variants of this function, virtual is overkill
 	virtual Glyph const* lookup(c32 codepoint) = 0;
+
+	// Lookup every character in `s` at once, `out` must have room for `s.count` glyphs.
+	// (one virtual call per string instead of one per character)
+	virtual void lookup_many(string s, Glyph const** out) = 0;
 	virtual void destroy() = 0;
 };
 
@@ -52,18 +86,23 @@ struct Font_Simple_ASCII {
 };
 
 // Fonts where the character atlas's are always the same
-struct Font_Static : public Font {
+struct Font_Static final : public Font {
 	VkDescriptorSet  texture;
 	Glyph_Table_Fast table;
+	Glyph_Table_Fast* subpixel_tables = nullptr; // variants [1, subpixel_variants)
 	VkImage          atlas_image;
 	VmaAllocation    atlas_allocation;
 	VkImageView      atlas_view;
 	
 	Font_Static() = default;
+	Font_Static(Font_Static const&) = delete;
+	Font_Static& operator=(Font_Static const&) = delete;
 
-	void create(void const* ttf_data, size_t size, float height, VkDescriptorSet set, VkSampler sampler);
+	// `subpixel_variants` > 1 enables subpixel positioning (for smooth scrolling/animated text)
+	void create(void const* ttf_data, size_t size, float height, VkDescriptorSet set, VkSampler sampler, u32 subpixel_variants = 1);
 
 	virtual Glyph const* lookup(c32 codepoint) override;
+	virtual void lookup_many(string s, Glyph const** out) override;
 	virtual void destroy() override;
 };
 
@@ -76,21 +115,22 @@ struct Font_Dynamic {
 
 
 static v2f32 bounding_box(Font* font, string s) {
-	Glyph const* glyph = nullptr;
+	Glyph const* glyphs[glyph_batch_size];
 	v2f32 pos = {0, font->height};
 	float max_width = 0.0f;
 
-	FS_FOR(s.count) {
-		auto c = s.data[i];
-		glyph = font->lookup(c);
-		if (c == '\n') {
-			max_width = std::max(max_width, pos.x);
-			pos.x = 0;
-			pos.y += font->height;
-			continue;
-		}
-		if (glyph) {
-			pos.x += glyph->advance;
+	for (u64 offset = 0; offset < s.count; offset += glyph_batch_size) {
+		auto chunk = s.substr(offset, glyph_batch_size);
+		font->lookup_many(chunk, glyphs);
+
+		FS_FOR(chunk.count) {
+			if (chunk.data[i] == '\n') {
+				max_width = std::max(max_width, pos.x);
+				pos.x = 0;
+				pos.y += font->height;
+				continue;
+			}
+			pos.x += glyphs[i]->advance;
 		}
 	}
 
@@ -0,0 +1,79 @@
+/**
+ *	______________              _____
+ *	___  ____/__(_)________________(_)____________
+ *	__  /_   __  /__  ___/_  ___/_  /_  __ \_  __ \
+ *	_  __/   _  / _(__  )_(__  )_  / / /_/ /  / / /
+ *	/_/      /_/  /____/ /____/ /_/  \____//_/ /_/
+ *
+ *
+ * @Author:       lazergenixdev@gmail.com
+ * @Development:  (https://github.com/lazergenixdev/Fission)
+ * @License:      MIT (see end of file)
+ */
+#pragma once
+#include <Fission/config.hpp>
+
+__FISSION_BEGIN__
+
+// Rolling frame time statistics (percentiles, max, histogram) over the last `window` frames.
+//
+// Frame times are kept in a ring and counted in a log-linear histogram,
+//  16 buckets for every power of 2 (the bucket is just the top bits of the float).
+//  A frame entering or leaving the window only touches one bucket, percentiles
+//  are found by walking the histogram and are within ~3% of the exact value.
+//  The max is exact, kept with a monotonic queue.
+struct Frame_Stats {
+	static constexpr u32 sub_bucket_bits = 4;
+	static constexpr u32 min_exponent    = 127 - 13; // 2^-13 s ~ 0.12 ms, anything faster goes in the first bucket
+	static constexpr u32 max_exponent    = 127 + 1;  // 2 s, anything slower goes in the last bucket
+	static constexpr u32 bucket_count    = (max_exponent - min_exponent) << sub_bucket_bits;
+
+	float* times     = nullptr; // ring of the last `window` frame times (seconds)
+	u32*   max_queue = nullptr; // ring indices of decreasing frame times, front is the max
+	u32    window    = 0;
+	u64    frame     = 0;       // frames added in total
+	u64    queue_begin = 0, queue_end = 0;
+	u32    counts[bucket_count];
+
+	void create(u32 window);
+	void destroy();
+	void reset();
+
+	void add(float seconds);
+
+	// Frames in the window right now
+	inline u32 count() const { return (u32)min(frame, (u64)window); }
+
+	// q in [0, 1], in seconds
+	float quantile(float q) const;
+	float maximum() const;
+
+	static u32   bucket(float seconds);
+	static float bucket_lower(u32 bucket);
+};
+
+__FISSION_END__
+
+/**
+ *	MIT License
+ *
+ *	Copyright (c) 2021-2023 lazergenixdev
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
@@ -0,0 +1,97 @@
+/**
+ *	______________              _____
+ *	___  ____/__(_)________________(_)____________
+ *	__  /_   __  /__  ___/_  ___/_  /_  __ \_  __ \
+ *	_  __/   _  / _(__  )_(__  )_  / / /_/ /  / / /
+ *	/_/      /_/  /____/ /____/ /_/  \____//_/ /_/
+ *
+ *
+ * @Author:       lazergenixdev@gmail.com
+ * @Development:  (https://github.com/lazergenixdev/Fission)
+ * @License:      MIT (see end of file)
+ */
+#pragma once
+#include <Fission/Core/Graphics.hh>
+
+__FISSION_BEGIN__
+
+// GPU timestamps around render passes and named regions.
+//
+// One query pool per frame in flight. A frame's results are read back after
+//  its fence has been waited on, when that frame slot comes around again,
+//  so reading them never stalls.
+struct Gpu_Timer {
+	static constexpr u32 max_regions = 32;
+	static constexpr u32 no_region   = ~u32(0);
+
+	struct Frame {
+		VkQueryPool pool = VK_NULL_HANDLE;
+		u32         count = 0;             // regions begun in this frame
+		char const* names[max_regions];
+		u64         cpu_submit_us = 0;     // GPU work is placed after this in the trace
+	};
+
+	// Most recent frame that was read back
+	struct Result {
+		char const* name;
+		float       ms;
+	};
+	Result results[max_regions];
+	u32    result_count = 0;
+	float  frame_ms     = 0.0f; // first begin to last end
+
+	Frame  frames[2];
+	double ns_per_tick = 0.0;
+	u64    valid_mask  = 0;    // timestamps can have less than 64 valid bits
+	bool   supported   = false;
+
+	void create(Graphics& gfx, u32 queue_family);
+	void destroy(Graphics& gfx);
+
+	// After the fence of `ctx->frame` was waited on and the command buffer has begun
+	void begin_frame(Render_Context* ctx);
+	// Right before the command buffer is submitted
+	void submit(Render_Context* ctx);
+
+	// Returns `no_region` when out of regions (or not supported), `end` ignores that
+	u32  begin(Render_Context* ctx, char const* name);
+	void end(Render_Context* ctx, u32 region);
+};
+
+// Times everything recorded in this scope on the GPU
+struct Gpu_Scope {
+	Render_Context* ctx;
+	u32             region;
+
+	Gpu_Scope(Gpu_Timer& timer, Render_Context* ctx, char const* name):
+		ctx(ctx), region(timer.begin(ctx, name)), timer(timer) {}
+	~Gpu_Scope() { timer.end(ctx, region); }
+private:
+	Gpu_Timer& timer;
+};
+
+__FISSION_END__
+
+/**
+ *	MIT License
+ *
+ *	Copyright (c) 2021-2023 lazergenixdev
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
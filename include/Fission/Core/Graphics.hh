@@ -25,8 +25,9 @@ VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE
 __FISSION_BEGIN__
 
 struct Graphics_Create_Info {
-	struct Window*   window;
+	struct Window*   window;       // null -> headless
 	VkPresentModeKHR present_mode;
+	VkExtent2D       extent;       // headless only
 };
 
 struct MSAA_Info {
@@ -92,6 +93,15 @@ struct FISSION_API Graphics
 	VkImage           sc_images       [max_sc_images];
 	VkImageView       sc_image_views  [max_sc_images];
 
+	// No window or swap chain, `sc_images` are plain images that are drawn
+	//  into and never presented (benchmarks, machines without a display)
+	bool              headless = false;
+	VmaAllocation     sc_image_allocations[max_sc_images];
+
+	// Layout `sc_images` are left in at the end of a frame,
+	//  PRESENT_SRC_KHR needs VK_KHR_swapchain so headless uses TRANSFER_SRC_OPTIMAL
+	VkImageLayout     sc_final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
 	// Main graphics command pool
 	VkCommandPool    command_pool;
 
@@ -123,6 +133,10 @@ struct Render_Pass {
 	VkRenderPass handle;
 	VkImage multisampled_image;
 
+	// GPU time between begin and end is shown under this name (see `Gpu_Timer`)
+	char const* name = "render pass";
+	u32 gpu_region;
+
 	inline constexpr operator VkRenderPass() const { return handle; }
 
 	void create(VkSampleCountFlagBits samples, bool clear);
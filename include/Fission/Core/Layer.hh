@@ -15,7 +15,15 @@
 #include <Fission/Base/String.hpp>
 #include <Fission/Base/Math/Vector.hpp>
 #include <Fission/Core/Input/Event.hh>
+#include <Fission/Core/Text_Layout.hh>
+#include <Fission/Core/Renderer_2D.hh>
+#include <Fission/Core/Log_File.hh>
+#include <Fission/Core/Frame_Stats.hh>
+#include <Fission/Core/Counters.hh>
+#include <Fission/Core/Console_Script.hh>
+#include <Fission/Core/Remote_Console.hh>
 #include <vector>
+#include <deque>
 
 __FISSION_BEGIN__
 
@@ -40,8 +48,27 @@ static inline constexpr void enable_layer(Layer& layer) noexcept {
 	layer.flags |= layer::enable;
 }
 
+// Overlay geometry that was already laid out, copied back into
+//  the renderers on frames where it did not need to change.
+struct Overlay_Geometry {
+	std::vector<Renderer_2D::vertex>          vertices;
+	std::vector<u16>                          indices;
+	std::vector<Textured_Renderer_2D::vertex> text_vertices;
+	std::vector<u16>                          text_indices;
+
+	// everything added to the renderers in between is kept
+	void record_begin();
+	void record_end();
+	void append();
+
+private:
+	Draw_Data start, text_start;
+};
+
 struct Debug_Layer {
 	// note: string is copied, no need to keep the string memory around :)
+	//  strings are only read again when the overlay refreshes, so adding
+	//  the same lines every frame is cheap
 	void add(string s);
 
 	template <size_t Buffer_Size = 64, typename...T>
@@ -52,6 +79,19 @@ struct Debug_Layer {
 		add(FS_str_make(buffer, count));
 	}
 
+	// Values shown as small graphs, written to the trace and listed by the `counters` command.
+	//  `name` is not copied, use string literals.
+	//  counter: the value right now (entities alive), stays until set again
+	//  plot:    an amount for this frame (bytes allocated), adds up during the frame
+	inline void counter(char const* name, float value) { counters.set(counters.find_or_add(name, Counters::kind_counter), value); }
+	inline void plot   (char const* name, float value) { counters.add(counters.find_or_add(name, Counters::kind_plot),    value); }
+
+	// Same, but the name is not searched for every call, for code that records every frame:
+	//	static u32 id = ~0u;
+	//	engine.debug_layer.counter(id, "entities", float(entity_count));
+	inline void counter(u32& id, char const* name, float value) { counters.set(counters.find_or_add(id, name, Counters::kind_counter), value); }
+	inline void plot   (u32& id, char const* name, float value) { counters.add(counters.find_or_add(id, name, Counters::kind_plot),    value); }
+
 	u32 flags = layer::enable | layer::debug_show_verbose;
 
 	float* frame_times;
@@ -59,6 +99,17 @@ struct Debug_Layer {
 	int frame_time_index = 0;
 
 	float cpu_time = 0.0f;
+
+	// Percentiles over a short and a long window (see `stats` command)
+	Frame_Stats frame_stats[2];
+
+	Counters counters;
+
+	// Frames slower than this are hitches (0 -> off), while `trace ring` is
+	//  recording, every hitch dumps the trace so we can see what was running
+	float hitch_budget = 1.0f / 30.0f;
+	u64   hitch_count  = 0;
+	float last_hitch   = 0.0f;
 	
 	string_view app_info_string;
 	std::vector<string_view> right_strings;
@@ -66,6 +117,22 @@ struct Debug_Layer {
 	std::vector<c8>          character_buffer;
 	int character_count_initial = 0;
 
+	// Static text is laid out once, numbers are refreshed this often,
+	//  frames in between only copy the geometry over
+	double refresh_interval = 0.1;
+
+	struct Layout_Key {
+		u32   flags;
+		u32   width;
+		u32   left_string_count;
+		float font_height;
+		bool operator==(Layout_Key const&) const = default;
+	};
+	Layout_Key       layout_key = {};
+	s64              last_refresh = 0;
+	Overlay_Geometry static_overlay;
+	Overlay_Geometry dynamic_overlay;
+
 	void handle_events(std::vector<struct Event>& events);
 	void on_update(double dt, struct Render_Context* ctx);
 	
@@ -74,16 +141,76 @@ struct Debug_Layer {
 
 private:
 	float draw_frame_time_graph(v2f32 top_left);
+	float draw_frame_time_histogram(v2f32 top_left);
+	float draw_counters(v2f32 top_left);
+	void  check_hitch(float dt);
+	void  draw_static_text();
+	void  draw_dynamic_text();
 	bool visible() const;
 };
 
+// Console text stored as a ring of lines.
+//
+// Text is written into a ring of bytes, and every line is kept contiguous so
+//  it can be drawn straight from the buffer. When the ring is full, the oldest
+//  lines are dropped, adding text never has to move the rest of the buffer.
+//
+// Positions are monotonic (total bytes written), `position % capacity` is the
+//  actual place in `data`. Line indices are monotonic as well.
+struct Console_Buffer {
+	struct Line {
+		u64  start;       // monotonic position of the first character
+		u32  count;       // number of characters (newline not included)
+
+		// filled in by the console layer when drawing
+		u32  rows;        // rows after wrapping, 0 = not laid out yet
+		u64  row_start;   // monotonic index of the first row
+
+		// color state at the start of the line
+		rgb8 color;
+		bool using_color;
+
+		u8   severity;    // highest severity of anything written to this line
+	};
+
+	c8*   data           = nullptr;
+	u64   capacity       = 0;
+	Line* lines          = nullptr;
+	u64   line_capacity  = 0; // power of 2
+	u64   first_line     = 0; // oldest line still in the buffer
+	u64   end_line       = 0; // one past the "open" line (the line still being written)
+
+	// color state at the end of the text
+	Text_Color_State color_state;
+	u32              color_bytes = 0; // bytes of a color code still to come
+
+	void create(u64 capacity, u64 max_lines);
+	void destroy();
+
+	void clear();
+	void append(string text, u8 severity = 0);
+
+	inline u64 line_count() const { return end_line - first_line; }
+
+	// `index` is a monotonic line index, [first_line, end_line)
+	inline Line&       line(u64 index)       { return lines[index & (line_capacity - 1)]; }
+	inline Line const& line(u64 index) const { return lines[index & (line_capacity - 1)]; }
+
+	inline string text(Line const& line) const {
+		return string{.count = line.count, .data = data + line.start % capacity};
+	}
+
+private:
+	void new_line();
+	void write(c8 const* text, u64 count, u8 severity);
+	void make_room(Line& open, u64 added_count);
+};
+
 // ESCXXXhelloESC
 // X for a byte [0,255] representing a color component
 // XXX => RGB
 struct Console_Layer {
 	u32 flags = layer::enable;
-	
-	static constexpr u64 default_buffer_size = FS_KILOBYTES(4);
 
 	float    position;
 
@@ -91,9 +218,55 @@ struct Console_Layer {
 	c8       input_buffer[72];
 	int      input_cursor = 2;
 
-	string   buffer_view; // fixed size console buffer to display stuff
-	u64      buffer_capacity;
-	int      buffer_view_offset = 0;
+	Console_Buffer buffer;
+	int            buffer_view_offset = 0; // in rows (after wrapping)
+
+	Text_Layout layout;          // line breaks for the line being laid out
+	float       layout_width;    // width the line `rows` were computed for
+	u64         layout_end_line; // lines before this have up-to-date `rows` and `row_start`
+
+	// rows that are on screen, only laid out again when the view changes
+	struct Visible_Row {
+		u64       line;
+		Text_Line row;
+	};
+	struct Visible_Key {
+		u64   bottom_row;
+		u64   first_line;
+		u64   end_line;
+		u32   open_count;
+		u32   max_rows;
+		float width;
+		u64   filter;
+		bool operator==(Visible_Key const&) const = default;
+	};
+	std::vector<Visible_Row> visible_rows;
+	Visible_Key              visible_key = {};
+	bool                     visible_at_end = false; // oldest (matching) line is on screen
+
+	// `find` and `filter` commands, only lines that match are shown
+	struct Line_Filter {
+		u8              min_severity = 0;
+		std::string     pattern;          // empty -> any text
+		std::deque<u64> matches;          // matching lines, the open line is checked every frame instead
+		u64             scanned_end = 0;  // lines before this have been checked
+		u32             generation  = 0;  // changes whenever the filter changes
+		u64             skip_line   = ~0ull; // "> find <text>" echo of the command itself, it would always match
+
+		inline bool active() const { return min_severity || !pattern.empty(); }
+	};
+	Line_Filter filter;
+
+	// bytes of history checked against the filter per frame,
+	//  searching through megabytes of history is spread out over a few frames
+	static constexpr u64 filter_scan_budget = FS_KILOBYTES(512);
+
+	Log_File       log_file; // optional copy of everything written to the console
+	Console_Script script;   // commands from a file (`exec`)
+	Remote_Console remote;   // commands from other processes (`remote`)
+
+	std::string* capture = nullptr; // when set, console thread output is also copied here
+	u64 command_echo_line = ~0ull;  // line the running command was echoed on, ~0 when it was not
 
 	s64              current_command = -1; // -1 == "user input", [0, command_count-1] == "command in command_history_buffer"
 	std::vector<u32> command_history_ends; // constains the end indicies for all commands in command_history_buffer
@@ -102,19 +275,24 @@ struct Console_Layer {
 	void handle_events(std::vector<struct Event>& events);
 	void on_update(double dt, struct Render_Context* ctx);
 
-	void setup_console_api();
+	void setup_console_api(struct Defaults const& defaults);
+
+	// console thread only, use `console::print` from everywhere else
+	void write(string text, u8 severity = 0);
 
 	void create();
 	void destroy();
 
-	void _reserve_space_for(u64 added_count);
 private:
+	void drain_log_queues();
+	void set_filter(u8 min_severity, string pattern);
+	void update_filter();
+	bool line_matches(Console_Buffer::Line const& line) const;
+	void draw_filtered_lines(struct Textured_Renderer_2D& r, float top, float ystride);
 	void draw_console_buffer(struct Textured_Renderer_2D& r, float top, float ystride);
 	void handle_character_input(Event::Character_Input in);
+	void complete_command();
 	string command_from_history();
-
-	static constexpr u64 minimum_buffer_delete_count = FS_KILOBYTES(1);
-	static constexpr u64 maximum_buffer_delete_count = FS_KILOBYTES(2);
 };
 
 __FISSION_END__
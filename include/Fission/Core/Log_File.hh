@@ -0,0 +1,101 @@
+/**
+ *	______________              _____
+ *	___  ____/__(_)________________(_)____________
+ *	__  /_   __  /__  ___/_  ___/_  /_  __ \_  __ \
+ *	_  __/   _  / _(__  )_(__  )_  / / /_/ /  / / /
+ *	/_/      /_/  /____/ /____/ /_/  \____//_/ /_/
+ *
+ *
+ * @Author:       lazergenixdev@gmail.com
+ * @Development:  (https://github.com/lazergenixdev/Fission)
+ * @License:      MIT (see end of file)
+ */
+#pragma once
+#include <Fission/config.hpp>
+#include <Fission/Base/String.hpp>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <cstdio>
+
+__FISSION_BEGIN__
+
+// Mirrors console output to a file on disk.
+//
+// Text is collected into large chunks on the console thread, and chunks are handed
+//  off to a writer thread through a lock-free ring; the console never waits on the disk.
+// If the writer falls behind and every chunk is full, text is dropped (and counted).
+//
+// Files are rotated once they grow past `max_file_size`:
+//  "name.log" -> "name.log.1" -> "name.log.2" ... up to `max_files`.
+struct Log_File {
+	static constexpr u64 chunk_size  = FS_KILOBYTES(64);
+	static constexpr u32 chunk_count = 8; // power of 2
+
+	bool open(string path, u64 max_file_size = FS_MEGABYTES(64), u32 max_files = 4);
+	void close();
+
+	inline bool is_open() const { return chunks != nullptr; }
+
+	// console thread only, color codes are stripped
+	void write(string text);
+
+	// called once per frame, hands off text that has been sitting around for a while
+	void flush();
+
+private:
+	struct Chunk {
+		u64 count;
+		c8  data[chunk_size];
+	};
+
+	void hand_off();
+	void rotate();
+	void writer_main();
+
+	FILE*       file = nullptr; // owned by the writer thread while open
+	std::string path;
+	u64         file_size;
+	u64         max_file_size;
+	u32         max_files;
+
+	Chunk* chunks = nullptr;
+
+	alignas(64) std::atomic<u64> chunks_filled  = 0; // only changed by the console thread
+	alignas(64) std::atomic<u64> chunks_written = 0; // only changed by the writer thread
+	std::atomic<u32>             wake           = 0; // changes whenever the writer has something to do
+	std::atomic<bool>            stop           = false;
+	std::thread                  writer;
+
+	// console thread state
+	u64  dropped = 0;
+	u32  frames_since_hand_off = 0;
+	u32  color_bytes = 0;
+	bool using_color = false;
+};
+
+__FISSION_END__
+
+/**
+ *	MIT License
+ *
+ *	Copyright (c) 2021-2023 lazergenixdev
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
@@ -0,0 +1,97 @@
+/**
+ *	______________              _____
+ *	___  ____/__(_)________________(_)____________
+ *	__  /_   __  /__  ___/_  ___/_  /_  __ \_  __ \
+ *	_  __/   _  / _(__  )_(__  )_  / / /_/ /  / / /
+ *	/_/      /_/  /____/ /____/ /_/  \____//_/ /_/
+ *
+ *
+ * @Author:       lazergenixdev@gmail.com
+ * @Development:  (https://github.com/lazergenixdev/Fission)
+ * @License:      MIT (see end of file)
+ */
+#pragma once
+#include <Fission/Core/Graphics.hh>
+
+__FISSION_BEGIN__
+
+// Where the memory goes: GPU heaps (VMA), the temporary storage behind `talloc`
+//  and how full the 2D renderers get every frame.
+//
+// Heap budgets are cheap and read every frame. `vmaCalculateStatistics` walks
+//  every block, so the free space numbers are only refreshed every `detail_interval`
+//  frames (or right away with `update_details`, the `mem` command does that).
+struct Memory_Stats {
+	static constexpr u32 detail_interval = 60;
+
+	struct Heap {
+		u64  budget;           // how much the driver thinks we can use
+		u64  usage;            // what this process is using (estimated without VK_EXT_memory_budget)
+		u64  block_bytes;      // memory VMA allocated from Vulkan
+		u64  allocation_bytes; // memory handed out from those blocks
+		u32  block_count;
+		u32  allocation_count;
+		bool device_local;
+
+		// detailed, free space inside the blocks (fragmentation)
+		u32  unused_range_count;
+		u64  largest_unused_range;
+		u64  largest_allocation;
+	};
+	Heap heaps[VK_MAX_MEMORY_HEAPS];
+	u32  heap_count = 0;
+
+	struct Arena {
+		char const* name;
+		u64 used, peak, size;
+	};
+	Arena temp_storage = {.name = "temp storage"};
+
+	// Vertices and indices written in one frame, against what the buffers can hold
+	struct Renderer {
+		char const* name;
+		u32 vertices, indices;
+		u32 peak_vertices, peak_indices;
+		u32 max_vertices, max_indices;
+	};
+	Renderer renderers[2] = {{.name = "renderer_2d"}, {.name = "textured_renderer_2d"}};
+
+	u64 frame = 0;
+
+	// counter ids (see `Debug_Layer::counter`)
+	u32 device_memory_counter = ~0u;
+	u32 temp_storage_counter  = ~0u;
+
+	// Before the renderers upload (and reset) their draw data
+	void update();
+	void update_details();
+
+	// Everything, for the console
+	void print() const;
+};
+
+__FISSION_END__
+
+/**
+ *	MIT License
+ *
+ *	Copyright (c) 2021-2023 lazergenixdev
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
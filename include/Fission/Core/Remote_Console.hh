@@ -0,0 +1,109 @@
+/**
+ *	______________              _____
+ *	___  ____/__(_)________________(_)____________
+ *	__  /_   __  /__  ___/_  ___/_  /_  __ \_  __ \
+ *	_  __/   _  / _(__  )_(__  )_  / / /_/ /  / / /
+ *	/_/      /_/  /____/ /____/ /_/  \____//_/ /_/
+ *
+ *
+ * @Author:       lazergenixdev@gmail.com
+ * @Development:  (https://github.com/lazergenixdev/Fission)
+ * @License:      MIT (see end of file)
+ */
+#pragma once
+#include <Fission/config.hpp>
+#include <Fission/Base/String.hpp>
+#include <vector>
+#include <string>
+#include <mutex>
+
+__FISSION_BEGIN__
+
+// Console that can be driven from another process through a local socket.
+//
+// Protocol (text, one request per line):
+//	<command>                 -> console output of the command, ended by a '\0' byte
+//	subscribe <counter>       -> "@<counter> <value>\n" sent every frame
+//	unsubscribe <counter|all>
+//
+// counters: frame_time_ms, cpu_time_ms
+//
+// A server thread owns the socket, commands are run on the console thread in `update`.
+//
+// Linux only (Unix domain sockets), on other platforms `start` prints that it is
+//  not supported and returns false.
+struct Remote_Console {
+	bool start(string path);
+	void stop();
+
+	// runs commands that came in, and sends counters (console thread, once per frame)
+	void update(double dt);
+
+	inline bool running() const { return server != nullptr; }
+
+	//////////////////////////////////////////////////////////////////////////
+	// shared with the server thread
+	struct Request {
+		u32         client;
+		bool        disconnected;
+		std::string command;
+	};
+	struct Response {
+		u32         client;
+		std::string text;
+	};
+
+	std::mutex            mutex;
+	std::vector<Request>  requests;
+	std::vector<Response> responses;
+
+private:
+	enum Counter: u32 {
+		frame_time_ms = 1 << 0,
+		cpu_time_ms   = 1 << 1,
+	};
+	struct Subscription {
+		u32 client;
+		u32 counters;
+	};
+
+	void send(u32 client, string text);
+	// `send`, ended by the '\0' byte that every command response ends with
+	void reply(u32 client, string text);
+	void subscribe(u32 client, string args, bool enable);
+
+	// wake up the server thread, there is something to send
+	void wake();
+
+	struct Remote_Server* server = nullptr; // platform specific
+
+	std::vector<Request>      pending;  // requests being run this frame
+	std::vector<Response>     outgoing; // responses made this frame
+	std::vector<Subscription> subscriptions;
+};
+
+__FISSION_END__
+
+/**
+ *	MIT License
+ *
+ *	Copyright (c) 2021-2023 lazergenixdev
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
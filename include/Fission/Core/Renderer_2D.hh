@@ -13,6 +13,7 @@
 #pragma once
 #include "Fission/Core/Graphics.hh"
 #include "Fission/Core/Font.hh"
+#include "Fission/Core/Renderer_2D_Capture.hh"
 #include "Fission/Base/Math/Matrix.hpp"
 #include "Fission/Base/Rect.hpp"
 #include "Fission/Base/Color.hpp"
@@ -283,6 +284,20 @@ public:
 		d.vtx_count += 4;
 	}
 
+	// Geometry that was made earlier with the other `add_` functions and kept around,
+	//  indices start at 0.
+	void add_geometry(vertex const* vertices, u32 vertex_count, u16 const* indices, u32 index_count) {
+		memcpy(vertex_data + d.total_vtx_count, vertices, vertex_count * sizeof(vertex));
+
+		u16* out = index_data + d.total_idx_count;
+		FS_FOR(index_count) out[i] = u16(indices[i] + d.vtx_count);
+
+		d.total_vtx_count += vertex_count;
+		d.total_idx_count += index_count;
+		d.vtx_count += vertex_count;
+		d.idx_count += index_count;
+	}
+
 	void add_circle(v2f32 position, float radius, color color) {
 		int vtx_count = min(max(int(radius), 10), 128);
 
@@ -385,6 +400,7 @@ public:
 		vkCmdSetScissor(ctx.command_buffer, 0, 1, &scissor);
 
 		vkCmdDrawIndexed(ctx.command_buffer, d.idx_count, 1, d.idx_offset, d.vtx_offset, 0);
+		if (r2d_capture::writer) r2d_capture::draw(r2d_capture::solid, pipeline != this->pipeline, nullptr, d.idx_offset, d.idx_count, d.vtx_offset);
 
 		d.start_new_draw();
 	}
@@ -433,6 +449,20 @@ public:
 		d.vtx_count += 4;
 	}
 
+	// Geometry that was made earlier with the other `add_` functions and kept around,
+	//  indices start at 0.
+	void add_geometry(vertex const* vertices, u32 vertex_count, u16 const* indices, u32 index_count) {
+		memcpy(vertex_data + d.total_vtx_count, vertices, vertex_count * sizeof(vertex));
+
+		u16* out = index_data + d.total_idx_count;
+		FS_FOR(index_count) out[i] = u16(indices[i] + d.vtx_count);
+
+		d.total_vtx_count += vertex_count;
+		d.total_idx_count += index_count;
+		d.vtx_count += vertex_count;
+		d.idx_count += index_count;
+	}
+
 	void add_glyph( const fs::Glyph* g, const v2f32& origin, const float& scale, const color& color )
 	{
 		index_data[d.total_idx_count++] = d.vtx_count;
@@ -458,6 +488,20 @@ public:
 		d.vtx_count += 4;
 	}
 
+	// place a glyph at a fractional x position using the closest subpixel variant
+	void add_glyph_subpixel(const fs::Glyph* g, v2f32 origin, const color& color) {
+		u32 const variants = current_font->subpixel_variants;
+
+		float x = floorf(origin.x);
+		u32 variant = u32((origin.x - x) * (float)variants + 0.5f);
+		if (variant >= variants) {
+			variant = 0;
+			x += 1.0f;
+		}
+
+		add_glyph(current_font->subpixel_glyph(g, variant), {x, origin.y}, 1.0f, color);
+	}
+
 	// exists so that there is no need to pass extra parameter to add_string
 	void set_font(struct Font* font) {
 		current_font = font;
@@ -470,27 +514,38 @@ public:
 		const float right  = top_right.x;
 		const float starty = top_right.y;
 		float width = 0.0f;
-		fs::Glyph const* glyph;
-
-		for (u64 i = 0; i < str.count; ++i)
-		{
-			u32 c = str.data[str.count - i - 1];
-			// newline
-			if (c == '\r' || c == '\n') {
-				float w = right - pos.x;
-				if (w > width)
-					width = w;
-
-				pos.y += current_font->height;
-				pos.x = right;
-				continue;
-			}
-
-			glyph = current_font->lookup(c);
-			pos.x -= glyph->advance;
-
-			if (c != ' ') {
-				add_glyph(glyph, pos, 1.0f, col);
+		fs::Glyph const* glyphs[glyph_batch_size];
+		bool const subpixel = current_font->subpixel_variants > 1;
+
+		// walk the string backwards, one batch at a time
+		u64 remaining = str.count;
+		while (remaining) {
+			u64 count = std::min(remaining, glyph_batch_size);
+			remaining -= count;
+
+			auto chunk = str.substr(remaining, count);
+			current_font->lookup_many(chunk, glyphs);
+
+			for (u64 i = chunk.count; i-- > 0;)
+			{
+				u32 c = chunk.data[i];
+				// newline
+				if (c == '\r' || c == '\n') {
+					float w = right - pos.x;
+					if (w > width)
+						width = w;
+
+					pos.y += current_font->height;
+					pos.x = right;
+					continue;
+				}
+
+				pos.x -= glyphs[i]->advance;
+
+				if (c != ' ') {
+					if (subpixel) add_glyph_subpixel(glyphs[i], pos, col);
+					else          add_glyph(glyphs[i], pos, 1.0f, col);
+				}
 			}
 		}
 
@@ -507,29 +562,35 @@ public:
 		const float left = top_left.x;
 		const float starty = top_left.y;
 		float width = 0.0f;
-		fs::Glyph const* glyph;
+		fs::Glyph const* glyphs[glyph_batch_size];
+		bool const subpixel = current_font->subpixel_variants > 1;
 
-		for (u64 i = 0; i < str.count; ++i)
+		for (u64 offset = 0; offset < str.count; offset += glyph_batch_size)
 		{
-			u32 c = str.data[i];
-			// newline
-			if (c == '\r' || c == '\n') {
-				float w = pos.x - left;
-				if (w > width)
-					width = w;
-
-				pos.y += current_font->height;
-				pos.x = left;
-				continue;
+			auto chunk = str.substr(offset, glyph_batch_size);
+			current_font->lookup_many(chunk, glyphs);
+
+			for (u64 i = 0; i < chunk.count; ++i)
+			{
+				u32 c = chunk.data[i];
+				// newline
+				if (c == '\r' || c == '\n') {
+					float w = pos.x - left;
+					if (w > width)
+						width = w;
+
+					pos.y += current_font->height;
+					pos.x = left;
+					continue;
+				}
+
+				if (c != ' ') {
+					if (subpixel) add_glyph_subpixel(glyphs[i], pos, col);
+					else          add_glyph(glyphs[i], pos, 1.0f, col);
+				}
+
+				pos.x += glyphs[i]->advance;
 			}
-
-			glyph = current_font->lookup(c);
-
-			if (c != ' ') {
-				add_glyph(glyph, pos, 1.0f, col);
-			}
-
-			pos.x += glyph->advance;
 		}
 
 		width = std::max(width, pos.x - left);
@@ -540,6 +601,7 @@ public:
 		if (d.total_vtx_count) {
 			auto& fd = frame_data[ctx->frame];
 			fd.set_data(ctx->gfx, vertex_data, index_data, d.total_vtx_count, d.total_idx_count);
+			if (r2d_capture::writer) r2d_capture::arrays(r2d_capture::textured, vertex_data, sizeof(vertex), d.total_vtx_count, index_data, d.total_idx_count);
 			d.reset();
 		}
 	}
@@ -571,6 +633,7 @@ public:
 		vkCmdSetScissor(ctx.command_buffer, 0, 1, &scissor);
 
 		vkCmdDrawIndexed(ctx.command_buffer, d.idx_count, 1, d.idx_offset, d.vtx_offset, 0);
+		if (r2d_capture::writer) r2d_capture::draw(r2d_capture::textured, pipeline != this->pipeline, current_font, d.idx_offset, d.idx_count, d.vtx_offset);
 
 		d.start_new_draw();
 	}
@@ -0,0 +1,94 @@
+/**
+ *	______________              _____
+ *	___  ____/__(_)________________(_)____________
+ *	__  /_   __  /__  ___/_  ___/_  /_  __ \_  __ \
+ *	_  __/   _  / _(__  )_(__  )_  / / /_/ /  / / /
+ *	/_/      /_/  /____/ /____/ /_/  \____//_/ /_/
+ *
+ *
+ * @Author:       lazergenixdev@gmail.com
+ * @Development:  (https://github.com/lazergenixdev/Fission)
+ * @License:      MIT (see end of file)
+ */
+#pragma once
+#include <Fission/config.hpp>
+#include <Fission/Base/String.hpp>
+
+__FISSION_BEGIN__
+
+struct Scene;
+struct Scene_Key;
+struct Font;
+
+// Records what the 2D renderers draw, frame by frame, into a .r2d file. The built in
+//  "r2d_replay" scene plays it back as fast as it can, without the game that made it.
+//
+// File: "FR2D", u32 version, u32 width, u32 height, u32 vertex size of both renderers,
+//  then for every frame: u32 size (of the rest of the frame), `Frame_Header`,
+//  `Draw`s, then the vertices and indices of `Renderer_2D` and `Textured_Renderer_2D`
+//  exactly as they were uploaded.
+namespace r2d_capture {
+	static constexpr u32 version = 1;
+
+	enum Renderer: u8 { solid, textured };
+	enum Font_Id:  u8 { font_none, font_debug, font_console, font_other };
+
+	struct Draw {
+		u8  renderer;
+		u8  custom_pipeline; // drawn with a pipeline the renderer does not own, replayed with its own
+		u8  font;            // `Font_Id` textured draws sample from
+		u8  _pad;
+		u32 idx_offset;
+		u32 idx_count;
+		u32 vtx_offset;
+	};
+
+	struct Frame_Header {
+		u32 draw_count;
+		u32 vtx_count[2];
+		u32 idx_count[2];
+	};
+
+	// Not null while capturing, the renderers check this
+	FISSION_API extern struct Writer* writer;
+
+	// Capturing starts with the next frame, stops by itself after `max_frames`
+	FISSION_API bool start(string filename, u32 max_frames);
+	FISSION_API void stop();
+
+	// Renderers
+	FISSION_API void draw(Renderer renderer, bool custom_pipeline, Font* font, u32 idx_offset, u32 idx_count, u32 vtx_offset);
+	FISSION_API void arrays(Renderer renderer, void const* vertices, u32 vertex_size, u32 vtx_count, u16 const* indices, u32 idx_count);
+
+	// Engine only, after the renderers have uploaded
+	void end_frame();
+
+	// "r2d_replay -file <path> [-loops <n>] [-quit]"
+	Scene* create_replay_scene(Scene_Key const& key);
+}
+
+__FISSION_END__
+
+/**
+ *	MIT License
+ *
+ *	Copyright (c) 2021-2023 lazergenixdev
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
@@ -69,7 +69,7 @@ struct Scene_Key {
 	}
 	void add_string(string key, string value) {
 		insert_string(key);
-		stream.emplace_back(Value::Float64);
+		stream.emplace_back(Value::String);
 		insert_string(value);
 	}
 	void add_float64(string key, f64 value) {
@@ -127,10 +127,11 @@ public:
 			value.v_string.data = (c8*)stream.data() + cursor;
 			cursor += value.v_string.count;
 		break; case Value::Int64:
-			value.v_s64 = *reinterpret_cast<s64 const*>(stream.data() + cursor);
+			// values are not aligned in the stream
+			memcpy(&value.v_s64, stream.data() + cursor, 8);
 			cursor += 8;
 		break; case Value::Float64:
-			value.v_f64 = *reinterpret_cast<f64 const*>(stream.data() + cursor);
+			memcpy(&value.v_f64, stream.data() + cursor, 8);
 			cursor += 8;
 			break;
 		}
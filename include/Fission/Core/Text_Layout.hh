@@ -0,0 +1,90 @@
+/**
+ *	______________              _____
+ *	___  ____/__(_)________________(_)____________
+ *	__  /_   __  /__  ___/_  ___/_  /_  __ \_  __ \
+ *	_  __/   _  / _(__  )_(__  )_  / / /_/ /  / / /
+ *	/_/      /_/  /____/ /____/ /_/  \____//_/ /_/
+ *
+ *
+ * @Author:       lazergenixdev@gmail.com
+ * @Development:  (https://github.com/lazergenixdev/Fission)
+ * @License:      MIT (see end of file)
+ */
+#pragma once
+#include <Fission/Core/Font.hh>
+#include <vector>
+
+__FISSION_BEGIN__
+
+namespace text_layout {
+	enum Flags: u32 {
+		// skip over console color codes (ESCXXX ... ESC), they take up no space
+		console_colors = 1 << 0,
+	};
+}
+
+// Color state of console colored text (ESCXXX ... ESC)
+struct Text_Color_State {
+	rgb8 color       = colors::White;
+	bool using_color = false;
+};
+
+// One line of text after line breaking
+struct Text_Line {
+	u32   offset; // index of the first character in the source text
+	u32   count;  // number of characters (newline not included)
+	float width;  // width in pixels
+
+	// color state at the start of the line (only with `text_layout::console_colors`)
+	rgb8  color;
+	bool  using_color;
+};
+
+// Measure text without drawing anything, `max_width <= 0` means no wrapping
+v2f32 measure_text(Font* font, string text, float max_width = 0.0f, u32 flags = 0, Text_Color_State start = {});
+
+// Breaks text into lines that fit inside `max_width`,
+//  breaking on spaces when possible and mid-word when a word is too long.
+//
+// Long logs are not laid out in one go, the console lays out one line
+//  of its buffer at a time (see `Console_Buffer`).
+struct Text_Layout {
+	Font* font       = nullptr;
+	float max_width  = 0.0f; // <= 0 -> no wrapping
+	u32   flags      = 0;
+
+	std::vector<Text_Line> lines;
+
+	void reset(Font* font, float max_width, u32 flags = 0);
+
+	// lay out all of `text` from scratch, `start` is the color state before the text
+	void layout(string text, Text_Color_State start = {});
+
+	v2f32 size() const;
+};
+
+__FISSION_END__
+
+/**
+ *	MIT License
+ *
+ *	Copyright (c) 2021-2023 lazergenixdev
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
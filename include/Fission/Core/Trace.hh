@@ -0,0 +1,92 @@
+/**
+ *	______________              _____
+ *	___  ____/__(_)________________(_)____________
+ *	__  /_   __  /__  ___/_  ___/_  /_  __ \_  __ \
+ *	_  __/   _  / _(__  )_(__  )_  / / /_/ /  / / /
+ *	/_/      /_/  /____/ /____/ /_/  \____//_/ /_/
+ *
+ *
+ * @Author:       lazergenixdev@gmail.com
+ * @Development:  (https://github.com/lazergenixdev/Fission)
+ * @License:      MIT (see end of file)
+ */
+#pragma once
+#include <Fission/config.hpp>
+#include <Fission/Base/String.hpp>
+#include <Fission/profiler.hpp>
+
+__FISSION_BEGIN__
+
+// Runtime switchable tracing of engine code (`trace start <file>` / `trace stop`),
+//  writes a .trace file for tools/trace_convert while the game is running.
+namespace trace {
+	// Not null while tracing, scopes record into this
+	FISSION_API extern profiler::Session* session;
+
+	// thread id of the GPU track (see `Gpu_Timer`)
+	static constexpr u16 gpu_thread = 1;
+
+	// All three take effect at the start of the next frame, outside of every scope
+	FISSION_API void start(string filename);
+	FISSION_API void stop();
+
+	// Keep the last `seconds` of events in memory only, `dump` writes them out
+	FISSION_API void start_ring(double seconds);
+
+	// Writes what the ring holds right now, on another thread so the frame keeps going.
+	//  Returns false when not recording a ring, or the last dump is still being written.
+	FISSION_API bool dump(string filename);
+
+	// Engine only, applies `start`/`stop`
+	void update();
+
+	// One sample of a counter track, `name` must outlive the session (string literals)
+	inline void counter(char const* name, float value) {
+		if (session) session->insert_counter(name, value);
+	}
+
+	// Records how long the current scope took, a single branch when not tracing.
+	//  Nested scopes can get the same timestamps, the converters sort out which one is inside.
+	struct Scope {
+		profiler::Session* session;
+		char const*        what;
+		u64                start_us;
+
+		inline Scope(char const* what): session(trace::session), what(what) {
+			if (session) start_us = profiler::timestamp_ns() / 1000;
+		}
+		inline ~Scope() {
+			if (!session) return;
+			u64 duration = profiler::timestamp_ns() / 1000 - start_us;
+			session->insert_event({ what, 0, (u32)min(duration, (u64)UINT32_MAX), start_us });
+		}
+	};
+}
+
+__FISSION_END__
+
+#define FS_TRACE_SCOPE(NAME) ::fs::trace::Scope FS_CAT2(_trace_scope_, __LINE__){NAME}
+
+/**
+ *	MIT License
+ *
+ *	Copyright (c) 2021-2023 lazergenixdev
+ *
+ *	Permission is hereby granted, free of charge, to any person obtaining a copy
+ *	of this software and associated documentation files (the "Software"), to deal
+ *	in the Software without restriction, including without limitation the rights
+ *	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *	copies of the Software, and to permit persons to whom the Software is
+ *	furnished to do so, subject to the following conditions:
+ *
+ *	The above copyright notice and this permission notice shall be included in all
+ *	copies or substantial portions of the Software.
+ *
+ *	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *	SOFTWARE.
+ */
@@ -106,7 +106,7 @@ namespace platform {
     };
     struct Window_Impl {
         std::thread       _thread;
-        xcb_connection_t* _connection;
+        xcb_connection_t* _connection = nullptr;
         xcb_screen_t*     _screen;
         xcb_window_t      _id;
     };
@@ -13,7 +13,7 @@
 	extern void wait_ms(int milliseconds);
 	
 	int main() {
-		profiler::Session session{100}; // max trace events = 100
+		profiler::Session session{100}; // max trace events = 100 (per thread)
 		
 		{
 			profiler::scoped_trace trace{&session, 0, "start"};
@@ -30,6 +30,9 @@
 		
 		session.save("out.trace");
 		
+		// or, to write events to disk while recording:
+		// session.start_streaming("out.trace"); ... session.stop_streaming();
+		
 		// this call can be seperate from the application doing the profile
 		generate_chrome_tracing_from_file("out.trace");
 	}
@@ -43,19 +46,64 @@
 #include <unordered_map>
 #include <stdexcept>
 #include <cstdlib>
-
-// Only windows is supported for now
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <charconv>
+#include <algorithm>
+#include <tuple>
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#if defined(_WIN32)
 #define PROFILER_PLATFORM_WINDOWS 1
-#undef PROFILER_PLATFORM_LINUX
-#undef PROFILER_PLATFORM_MACOS
+#include <malloc.h>
+#elif defined(__linux__)
+#define PROFILER_PLATFORM_LINUX 1
+#include <time.h>
+#elif defined(__APPLE__)
+#define PROFILER_PLATFORM_MACOS 1
+#include <time.h>
+#endif
 
 namespace profiler {
 
+// Monotonic timestamp in nanoseconds, unaffected by changes to the wall clock
+inline uint64_t timestamp_ns() {
+#ifdef PROFILER_PLATFORM_WINDOWS
+	// QueryPerformanceCounter
+	using namespace std::chrono;
+	return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#else
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1'000'000'000 + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+// 64 byte aligned allocations, `size` does not need to be a multiple of 64
+inline void* aligned_alloc64(size_t size) {
+	size = (size + 63) & ~size_t(63);
+	if (size == 0) size = 64;
+#ifdef PROFILER_PLATFORM_WINDOWS
+	return _aligned_malloc(size, 64);
+#else
+	return std::aligned_alloc(64, size);
+#endif
+}
+
+inline void aligned_free64(void* ptr) {
 #ifdef PROFILER_PLATFORM_WINDOWS
-using int_sync = volatile long;
-#define PROFILER_INTERLOCKED_INC(X) _InterlockedIncrement(&X)
-#define PROFILER_INTERLOCKED_DEC(X) _InterlockedDecrement(&X)
+	_aligned_free(ptr);
+#else
+	std::free(ptr);
 #endif
+}
 
 #define PROFILER_XRESULTS \
 X(Failed, "operation failed") \
@@ -82,6 +130,9 @@ static constexpr char const* error_str(result r) {
 // takes a .trace file and creates a chrome tracing JSON file
 result generate_chrome_tracing_from_file(char const* in_filename, char const* out_filename = "trace.json");
 
+// takes a .trace file and creates a Perfetto protobuf trace (ui.perfetto.dev)
+result generate_perfetto_from_file(char const* in_filename, char const* out_filename = "trace.pftrace");
+
 // 16 bytes per trace event
 struct Raw_Trace_Event {
 	uint16_t whatid;
@@ -90,6 +141,26 @@ struct Raw_Trace_Event {
 	uint64_t timestamp_us;
 };
 
+// .trace files are a header followed by records, so they can be written while recording:
+//   "FTRC" u32 version
+//   { u32 tag, u32 size, u8 data[size] } ...
+// Names get an id the first time they are used, the name record always comes before events using it.
+namespace trace_file {
+	static constexpr char     magic[4] = { 'F', 'T', 'R', 'C' };
+	static constexpr uint32_t version  = 2;
+
+	enum tag : uint32_t {
+		tag_Name         = 'N', // u32 id, characters of the name
+		tag_Thread_Names = 'T', // null terminated names, index is the thread id
+		tag_Events       = 'E', // Raw_Trace_Event[size / sizeof(Raw_Trace_Event)]
+	};
+
+	struct Record_Header {
+		uint32_t tag;
+		uint32_t size;
+	};
+}
+
 struct Trace_Event {
 	char const* what;
 	uint16_t threadid;
@@ -97,34 +168,108 @@ struct Trace_Event {
 	uint64_t timestamp_us;
 };
 
+// Events with this thread id are counter samples: `what` names the counter and
+//  `duration_us` holds the bits of the (float) value. Converters give every counter its own track.
+static constexpr uint16_t counter_thread = 0xFFFF;
+
+inline uint32_t counter_bits(float value) { uint32_t bits; memcpy(&bits, &value, sizeof(bits)); return bits; }
+inline float    counter_value(uint32_t bits) { float value; memcpy(&value, &bits, sizeof(value)); return value; }
+
+// when an event is over, counter samples take no time
+template <typename Event>
+inline uint64_t event_end_us(Event const& e) {
+	return e.threadid == counter_thread ? e.timestamp_us : e.timestamp_us + e.duration_us;
+}
+
+enum mode {
+	mode_Fill, // keep the first events, drop events once a thread's buffer is full
+	mode_Ring, // keep the most recent events, dump right after something interesting happens
+};
+
+// Events recorded by one thread, only that thread ever writes to it
+struct alignas(64) Thread_Buffer {
+	Trace_Event*          events;
+	uint32_t              capacity;  // power of 2
+	std::atomic<uint64_t> written;   // total events written, index into `events` is `written % capacity`
+	std::atomic<uint64_t> read;      // events before this are on disk (streaming), their slots can be reused
+	std::thread::id       owner;     // a thread that exited may hand its buffer to a new thread with the same id
+	Thread_Buffer*        next;
+};
+
 struct Session
 {
 public:
-	Trace_Event* trace_data;
-	int          trace_count;  // total number of traces we can contain
-	int_sync     trace_occupied; // how many traces we have
-
 	Session() noexcept:
-		trace_data(nullptr), trace_count(0),
-		trace_occupied(0), thread_names(nullptr),
+		buffers(nullptr), events_per_thread(0),
+		recording_mode(mode_Fill), ring_us(0), id(0),
+		streamer(nullptr), thread_names(nullptr),
 		thread_count(0), thread_names_size(0)
 	{}
-	Session(int max_trace_count) noexcept { init(max_trace_count); }
+	Session(int max_trace_count, mode m = mode_Fill, double ring_seconds = 0.0) noexcept:
+		Session() { init(max_trace_count, m, ring_seconds); }
 	~Session() noexcept { uninit(); }
 
-	void init(int max_trace_count) noexcept;
+	// `max_trace_count` is per thread, buffers are created the first time a thread inserts an event.
+	// In `mode_Ring`, only events from the last `ring_seconds` are saved (0 -> all that fit)
+	void init(int max_trace_count, mode m = mode_Fill, double ring_seconds = 0.0) noexcept;
 	void uninit() noexcept;
 
-	void insert_event(Trace_Event const& event);
+	inline void insert_event(Trace_Event const& event) {
+		auto buffer = thread_buffer();
+		if (!buffer) return;
+
+		// no other thread writes `written`, no need for read-modify-write
+		uint64_t index = buffer->written.load(std::memory_order_relaxed);
+		if (recording_mode == mode_Fill && index - buffer->read.load(std::memory_order_acquire) >= buffer->capacity) return;
+
+		buffer->events[index & (buffer->capacity - 1)] = event;
+		buffer->written.store(index + 1, std::memory_order_release);
+	}
+	inline void insert_counter(char const* name, float value) {
+		insert_event({ name, counter_thread, counter_bits(value), timestamp_ns() / 1000 });
+	}
 	void name_threads(char const** ptr_thread_name_strings, int count);
 	
 	// Must not be called while inserting an event!
-	void reset() { trace_occupied = 0; }
+	void reset();
 
 	// Generate a .trace file
-	// Must not be called while inserting an event!
+	// In `mode_Fill`, must not be called while inserting an event!
+	// In `mode_Ring`, can be called any time, events overwritten while saving are left out.
 	void save(char const* filename);
+
+	// Write events to a .trace file from a background thread while recording (`mode_Fill` only),
+	//  thread buffers only need to hold what is recorded between two flushes.
+	// Call `name_threads` before this.
+	result start_streaming(char const* filename, double flush_interval_seconds = 0.1);
+	void stop_streaming();
+	bool is_streaming() const { return streamer != nullptr; }
 private:
+	std::atomic<Thread_Buffer*> buffers; // every thread that has inserted an event
+	uint32_t events_per_thread;
+	mode     recording_mode;
+	uint64_t ring_us;
+	uint64_t id; // unique for every init(), tells threads their cached buffer is stale
+
+	struct Thread_Cache {
+		uint64_t       session_id;
+		Thread_Buffer* buffer;
+	};
+	// one entry per live session a thread records into, most recent first
+	static constexpr int thread_cache_size = 4;
+	static inline thread_local Thread_Cache t_cache[thread_cache_size] = {};
+	static inline std::atomic<uint64_t> s_next_id = 1;
+
+	inline Thread_Buffer* thread_buffer() {
+		for (auto& c : t_cache) if (c.session_id == id) return c.buffer;
+		return register_thread();
+	}
+	Thread_Buffer* register_thread();
+
+	struct Streamer;
+	Streamer* streamer;
+	void flush_to_stream();
+
 	char* thread_names;
 	int thread_count;
 	int thread_names_size;
@@ -133,139 +278,542 @@ private:
 
 #ifdef PROFILER_IMPLEMENTATION
 
-#define _aligned64_mallocT(COUNT,TYPE) (TYPE*)_aligned_malloc(COUNT*sizeof(TYPE), 64)
-#define _read_into(STREAM,VAR)         STREAM.read((char*)&VAR, sizeof(VAR))
+#define _aligned64_mallocT(COUNT,TYPE) (TYPE*)aligned_alloc64((COUNT)*sizeof(TYPE))
 #define _write_from(STREAM,VAR)        STREAM.write((char*)&VAR, sizeof(VAR))
-#define _u64_to_str(BUFFER, VALUE)     _ui64toa_s((unsigned long long)VALUE, BUFFER, std::size(BUFFER), 10)
 
-inline result generate_chrome_tracing_from_file(char const* in_filename, char const* out_filename)
-{
-	using f = std::ios;
+namespace convert {
+	// Buffered output, numbers are written with to_chars straight into the buffer
+	struct Output {
+		FILE*  file  = nullptr;
+		size_t count = 0;
+		bool   failed = false;
+		char   data[1 << 16];
+
+		~Output() { close(); }
 
-	auto is = std::ifstream( in_filename, f::binary);
-	if( !is.is_open() ) {
-		return result_Error_FailedToOpenFile;
+		bool open(char const* filename) {
+			file = fopen(filename, "wb");
+			return file != nullptr;
+		}
+		bool close() {
+			if (!file) return !failed;
+			flush();
+			failed |= (fclose(file) != 0);
+			file = nullptr;
+			return !failed;
+		}
+		void flush() {
+			if (count && fwrite(data, 1, count, file) != count) failed = true;
+			count = 0;
+		}
+		void write(char const* text, size_t n) {
+			if (count + n > sizeof(data)) {
+				flush();
+				if (n > sizeof(data)) {
+					if (fwrite(text, 1, n, file) != n) failed = true;
+					return;
+				}
+			}
+			memcpy(data + count, text, n);
+			count += n;
+		}
+		void write(std::string const& text) { write(text.data(), text.size()); }
+		template <size_t N>
+		void literal(char const (&text)[N]) { write(text, N - 1); }
+		void u64(uint64_t value) {
+			if (count + 20 > sizeof(data)) flush();
+			count = std::to_chars(data + count, data + sizeof(data), value).ptr - data;
+		}
+		void f32(float value) {
+			if (count + 32 > sizeof(data)) flush();
+			if (value != value || value - value != 0.0f) value = 0.0f; // not valid JSON
+			count = std::to_chars(data + count, data + sizeof(data), value).ptr - data;
+		}
+	};
+
+	// Whole .trace file in memory, one read instead of one call per character
+	struct Trace {
+		std::vector<std::string>     names;
+		std::vector<std::string>     thread_names;
+		std::vector<Raw_Trace_Event> events;
+	};
+
+	inline result read_trace(char const* filename, Trace& trace) {
+		FILE* file = fopen(filename, "rb");
+		if (!file) return result_Error_FailedToOpenFile;
+
+		std::vector<char> data;
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		if (size > 0) {
+			data.resize((size_t)size);
+			data.resize(fread(data.data(), 1, data.size(), file));
+		}
+		fclose(file);
+
+		size_t const header_size = sizeof(trace_file::magic) + sizeof(uint32_t);
+		if (data.size() < header_size || memcmp(data.data(), trace_file::magic, sizeof(trace_file::magic)) != 0)
+			return result_Error_Failed;
+
+		uint32_t version;
+		memcpy(&version, data.data() + sizeof(trace_file::magic), sizeof(version));
+		if (version != trace_file::version) return result_Error_Failed;
+
+		// first pass to size the event array
+		size_t event_count = 0;
+		for (size_t at = header_size; at + sizeof(trace_file::Record_Header) <= data.size();) {
+			trace_file::Record_Header record;
+			memcpy(&record, data.data() + at, sizeof(record));
+			at += sizeof(record);
+			if (record.size > data.size() - at) break;
+			if (record.tag == trace_file::tag_Events) event_count += record.size / sizeof(Raw_Trace_Event);
+			at += record.size;
+		}
+		trace.events.reserve(event_count);
+
+		for (size_t at = header_size; at + sizeof(trace_file::Record_Header) <= data.size();) {
+			trace_file::Record_Header record;
+			memcpy(&record, data.data() + at, sizeof(record));
+			at += sizeof(record);
+
+			// file was cut off while streaming, keep what is complete
+			if (record.size > data.size() - at) break;
+
+			char const* payload = data.data() + at;
+			at += record.size;
+
+			switch (record.tag) {
+			case trace_file::tag_Name: {
+				uint32_t id;
+				if (record.size < sizeof(id)) return result_Error_Failed;
+				memcpy(&id, payload, sizeof(id));
+				if (id >= trace.names.size()) trace.names.resize(id + 1);
+				trace.names[id].assign(payload + sizeof(id), record.size - sizeof(id));
+				break;
+			}
+			case trace_file::tag_Thread_Names: {
+				trace.thread_names.clear();
+				for (size_t i = 0; i < record.size;) {
+					size_t n = strnlen(payload + i, record.size - i);
+					trace.thread_names.emplace_back(payload + i, n);
+					i += n + 1;
+				}
+				break;
+			}
+			case trace_file::tag_Events: {
+				size_t count = record.size / sizeof(Raw_Trace_Event);
+				size_t first = trace.events.size();
+				trace.events.resize(first + count);
+				memcpy(trace.events.data() + first, payload, count * sizeof(Raw_Trace_Event));
+				break;
+			}
+			default: break; // newer record, skip it
+			}
+		}
+		return result_Success;
 	}
-	is.exceptions(f::badbit | f::failbit);
-	
-	auto os = std::ofstream(out_filename, f::binary);
-	if( !os.is_open() ) {
-		return result_Error_FailedToCreateFile;
+
+	// Timestamps are not unique (scopes only read the clock, they do not wait for it to tick).
+	//  Slices that start together go outer first: longer first, and with the same length the one
+	//  recorded last (scopes are recorded when they end, so the outer one comes after).
+	//  Counter samples at the same time keep the order they were recorded in.
+	inline std::vector<uint32_t> timestamp_order(Trace const& trace) {
+		std::vector<uint32_t> order(trace.events.size());
+		for (uint32_t i = 0; i < (uint32_t)order.size(); ++i) order[i] = i;
+
+		auto key = [&trace](uint32_t i) {
+			auto const& e = trace.events[i];
+			bool counter = e.threadid == counter_thread;
+			return std::tuple{ e.timestamp_us, counter ? 0u : ~e.duration_us, counter ? i : ~i };
+		};
+		std::sort(order.begin(), order.end(), [&key](uint32_t a, uint32_t b) { return key(a) < key(b); });
+		return order;
 	}
-	os.exceptions(f::badbit | f::failbit);
 
+	// Names used to be written as they are, a `"` or `\` in a name made the JSON invalid.
+	//  Now those are escaped and control characters are left out, other names come out the same.
+	inline void json_escape(std::string& out, std::string const& text) {
+		for (char c : text) {
+			if (c == '"' || c == '\\') out += '\\';
+			if ((unsigned char)c < 0x20) continue;
+			out += c;
+		}
+	}
 
-	try {
-		uint32_t count;
-		_read_into(is, count);
+	// Protocol buffer encoding, only what is needed for Perfetto's TracePacket
+	struct Proto {
+		std::string data;
 
-		// this is truly something special :(
-		std::vector<std::string> functions;
-		functions.reserve(count);
-		std::string tmp;
-		while (functions.size() < count) {
-			char ch = (char)is.get();
-			if (ch == '\0') {
-				functions.emplace_back(std::move(tmp));
+		void varint(uint64_t value) {
+			while (value >= 0x80) {
+				data += char((value & 0x7F) | 0x80);
+				value >>= 7;
 			}
-			else tmp.push_back(ch);
+			data += char(value);
+		}
+		void tag(uint32_t field, uint32_t wire_type) { varint((uint64_t(field) << 3) | wire_type); }
+		void uint(uint32_t field, uint64_t value) { tag(field, 0); varint(value); }
+		void f64(uint32_t field, double value) {
+			tag(field, 1);
+			char bytes[8];
+			memcpy(bytes, &value, sizeof(bytes)); // little endian, same as the wire format
+			data.append(bytes, sizeof(bytes));
+		}
+		void bytes(uint32_t field, char const* text, size_t n) {
+			tag(field, 2);
+			varint(n);
+			data.append(text, n);
 		}
+		void string(uint32_t field, std::string const& text) { bytes(field, text.data(), text.size()); }
+		void message(uint32_t field, Proto const& m) { bytes(field, m.data.data(), m.data.size()); }
+	};
+}
 
-		uint32_t thread_count;
-		_read_into(is, thread_count);
+// takes a .trace file and creates a chrome tracing JSON file
+inline result generate_chrome_tracing_from_file(char const* in_filename, char const* out_filename)
+{
+	convert::Trace trace;
+	if (auto r = convert::read_trace(in_filename, trace)) return r;
+
+	convert::Output out;
+	if (!out.open(out_filename)) return result_Error_FailedToCreateFile;
+
+	// everything between "dur" and "ts" only depends on the name and thread, build it once
+	std::vector<std::string> name_parts(trace.names.size());
+	for (size_t i = 0; i < name_parts.size(); ++i) {
+		name_parts[i] = R"(,"name":")";
+		convert::json_escape(name_parts[i], trace.names[i]);
+		name_parts[i] += R"(","ph":"X","pid":0,"tid":)";
+	}
+	std::vector<std::string> thread_parts(trace.thread_names.size());
+	for (size_t i = 0; i < thread_parts.size(); ++i) {
+		thread_parts[i] = '"';
+		convert::json_escape(thread_parts[i], trace.thread_names[i]);
+		thread_parts[i] += '"';
+	}
+	static std::string const unknown_name = R"(,"name":"","ph":"X","pid":0,"tid":)";
+
+	// {"name":"entities","ph":"C","pid":0,"ts":834734345,"args":{"value":12}}
+	std::vector<std::string> counter_parts(trace.names.size());
+	for (size_t i = 0; i < counter_parts.size(); ++i) {
+		counter_parts[i] = R"({"name":")";
+		convert::json_escape(counter_parts[i], trace.names[i]);
+		counter_parts[i] += R"(","ph":"C","pid":0,"ts":)";
+	}
+	static std::string const unknown_counter = R"({"name":"","ph":"C","pid":0,"ts":)";
 
-		std::vector<std::string> thread_names;
-		thread_names.reserve(thread_count);
-		while (thread_names.size() < thread_count) {
-			char ch = (char)is.get();
-			if (ch == '\0') {
-				thread_names.emplace_back(std::move(tmp));
-			}
-			else tmp.push_back(ch);
+	out.literal(R"({"otherData":{},"traceEvents":[)");
+
+	bool first = true;
+	for (uint32_t index : convert::timestamp_order(trace)) {
+		auto const& event = trace.events[index];
+		/*
+		{
+			"cat": "function",
+			"dur": 600,
+			"name": "void main()",
+			"ph": "X",
+			"pid": 0,
+			"tid": "Main Thread",
+			"ts": 834734345
+		},
+		*/
+		if (!first) out.literal(",");
+		first = false;
+
+		if (event.threadid == counter_thread) {
+			out.write(event.whatid < counter_parts.size() ? counter_parts[event.whatid] : unknown_counter);
+			out.u64(event.timestamp_us);
+			out.literal(R"(,"args":{"value":)");
+			out.f32(counter_value(event.duration_us));
+			out.literal("}}");
+			continue;
 		}
 
-		uint32_t event_count;
-		_read_into(is, event_count);
-
-		os << R"({"otherData":{},"traceEvents":[)";
-
-		char buffer[72]; // big buffer just in case
-		Raw_Trace_Event trace;
-		for (uint32_t k = 0;;) {
-			_read_into(is, trace);
-			/*
-			{
-				"cat": "function",
-				"dur": 600,
-				"name": "void main()",
-				"ph": "X",
-				"pid": 0,
-				"tid": "Main Thread",
-				"ts": 834734345
-			},
-			*/
-			os << R"({"cat":"function","dur":)";
-
-			// duration
-			_u64_to_str(buffer, trace.duration_us);
-			os << buffer;
-
-			os << R"(,"name":")";
-
-			// name
-			os << functions[trace.whatid];
-
-			os << R"(","ph":"X","pid":0,"tid":)";
-
-			// thread id
-			if (trace.threadid < thread_count) {
-				os << '"' << thread_names[trace.threadid] << '"';
-			}
-			else {
-				_u64_to_str(buffer, trace.threadid);
-				os << buffer;
-			}
+		out.literal(R"({"cat":"function","dur":)");
+		out.u64(event.duration_us);
 
-			os << R"(,"ts":)";
+		out.write(event.whatid < name_parts.size() ? name_parts[event.whatid] : unknown_name);
 
-			// timestamp
-			_u64_to_str(buffer, trace.timestamp_us);
-			os << buffer;
+		if (event.threadid < thread_parts.size()) out.write(thread_parts[event.threadid]);
+		else                                      out.u64(event.threadid);
 
-			os << '}';
-			if (++k < event_count) {
-				os << ',';
-			}
-			else break;
+		out.literal(R"(,"ts":)");
+		out.u64(event.timestamp_us);
+		out.literal("}");
+	}
+	out.literal("]}");
+
+	return out.close() ? result_Success : result_Error_Failed;
+}
+
+// takes a .trace file and creates a Perfetto protobuf trace,
+//  loads much faster than JSON in ui.perfetto.dev for big captures
+inline result generate_perfetto_from_file(char const* in_filename, char const* out_filename)
+{
+	using convert::Proto;
+
+	// perfetto.protos field numbers
+	enum : uint32_t {
+		Trace_packet                      = 1,
+		TracePacket_timestamp             = 8,
+		TracePacket_sequence_id           = 10,
+		TracePacket_track_event           = 11,
+		TracePacket_interned_data         = 12,
+		TracePacket_sequence_flags        = 13,
+		TracePacket_track_descriptor      = 60,
+		TrackDescriptor_uuid              = 1,
+		TrackDescriptor_name              = 2,
+		TrackDescriptor_process           = 3,
+		TrackDescriptor_thread            = 4,
+		TrackDescriptor_parent_uuid       = 5,
+		TrackDescriptor_counter           = 8,
+		ProcessDescriptor_pid             = 1,
+		ProcessDescriptor_process_name    = 6,
+		ThreadDescriptor_pid              = 1,
+		ThreadDescriptor_tid              = 2,
+		ThreadDescriptor_thread_name      = 5,
+		TrackEvent_type                   = 9,
+		TrackEvent_name_iid               = 10,
+		TrackEvent_track_uuid             = 11,
+		TrackEvent_double_counter_value   = 44,
+		InternedData_event_names          = 2,
+		EventName_iid                     = 1,
+		EventName_name                    = 2,
+		TYPE_SLICE_BEGIN                  = 1,
+		TYPE_SLICE_END                    = 2,
+		TYPE_COUNTER                      = 4,
+		SEQ_INCREMENTAL_STATE_CLEARED     = 1,
+		SEQ_NEEDS_INCREMENTAL_STATE       = 2,
+	};
+	static constexpr uint32_t sequence_id  = 1;
+	static constexpr uint64_t process_uuid = 1;
+	static constexpr int      pid          = 1;
+	auto thread_uuid  = [](uint16_t threadid) { return process_uuid + 1 + threadid; };
+	auto counter_uuid = [](uint32_t whatid) { return process_uuid + 1 + counter_thread + 1 + whatid; };
+
+	convert::Trace trace;
+	if (auto r = convert::read_trace(in_filename, trace)) return r;
+
+	convert::Output out;
+	if (!out.open(out_filename)) return result_Error_FailedToCreateFile;
+
+	Proto header;
+	auto packet = [&out, &header](Proto const& p) {
+		header.data.clear();
+		header.tag(Trace_packet, 2);
+		header.varint(p.data.size());
+		out.write(header.data);
+		out.write(p.data);
+	};
+
+	// tracks, one per thread
+	{
+		Proto process, track, p;
+		process.uint(ProcessDescriptor_pid, pid);
+		process.string(ProcessDescriptor_process_name, "Fission");
+		track.uint(TrackDescriptor_uuid, process_uuid);
+		track.message(TrackDescriptor_process, process);
+		p.message(TracePacket_track_descriptor, track);
+		packet(p);
+	}
+	uint32_t thread_count = (uint32_t)trace.thread_names.size();
+	std::vector<bool> is_counter(trace.names.size());
+	for (auto&& event : trace.events) {
+		if (event.threadid != counter_thread) thread_count = std::max(thread_count, (uint32_t)event.threadid + 1);
+		else if (event.whatid < is_counter.size()) is_counter[event.whatid] = true;
+	}
+
+	for (uint32_t i = 0; i < thread_count; ++i) {
+		Proto thread, track, p;
+		thread.uint(ThreadDescriptor_pid, pid);
+		thread.uint(ThreadDescriptor_tid, pid + 1 + i);
+		thread.string(ThreadDescriptor_thread_name, i < trace.thread_names.size() ? trace.thread_names[i] : "Thread " + std::to_string(i));
+		track.uint(TrackDescriptor_uuid, thread_uuid((uint16_t)i));
+		track.uint(TrackDescriptor_parent_uuid, process_uuid);
+		track.message(TrackDescriptor_thread, thread);
+		p.message(TracePacket_track_descriptor, track);
+		packet(p);
+	}
+
+	// tracks, one per counter
+	for (uint32_t i = 0; i < (uint32_t)is_counter.size(); ++i) {
+		if (!is_counter[i]) continue;
+		Proto track, p;
+		track.uint(TrackDescriptor_uuid, counter_uuid(i));
+		track.uint(TrackDescriptor_parent_uuid, process_uuid);
+		track.string(TrackDescriptor_name, trace.names[i]);
+		track.message(TrackDescriptor_counter, Proto{}); // empty CounterDescriptor
+		p.message(TracePacket_track_descriptor, track);
+		packet(p);
+	}
+
+	// every name up front, events only refer to them by id
+	{
+		Proto interned, p;
+		for (size_t i = 0; i < trace.names.size(); ++i) {
+			Proto name;
+			name.uint(EventName_iid, i + 1);
+			name.string(EventName_name, trace.names[i]);
+			interned.message(InternedData_event_names, name);
+		}
+		p.uint(TracePacket_sequence_id, sequence_id);
+		p.uint(TracePacket_sequence_flags, SEQ_INCREMENTAL_STATE_CLEARED);
+		p.message(TracePacket_interned_data, interned);
+		packet(p);
+	}
+
+	// complete events become a begin and an end, in timestamp order
+	//  (counter samples stay one edge, `duration_us` is their value)
+	struct Edge {
+		uint64_t timestamp_us;
+		uint32_t duration_us;
+		uint32_t whatid;
+		uint32_t sequence; // index in the file, scopes are recorded when they end (inner first)
+		uint16_t threadid;
+		uint16_t end;
+	};
+	std::vector<Edge> edges;
+	edges.reserve(trace.events.size() * 2);
+	for (uint32_t i = 0; i < (uint32_t)trace.events.size(); ++i) {
+		auto const& event = trace.events[i];
+		if (event.threadid == counter_thread) {
+			if (event.whatid < is_counter.size()) edges.emplace_back(Edge{ event.timestamp_us, event.duration_us, event.whatid, i, event.threadid, 0 });
+			continue;
 		}
-		os << R"(]})";
+		edges.emplace_back(Edge{ event.timestamp_us, event.duration_us, event.whatid, i, event.threadid, 0 });
+		edges.emplace_back(Edge{ event.timestamp_us + event.duration_us, event.duration_us, event.whatid, i, event.threadid, 1 });
 	}
+	// at the same time: ends before begins (except for empty slices), inner slices end first and begin last,
+	//  slices of the same length are told apart by the order they were recorded in
+	auto rank = [](Edge const& e) { return e.end ? (e.duration_us ? 0 : 2) : 1; };
+	std::sort(edges.begin(), edges.end(), [&rank](Edge const& a, Edge const& b) {
+		if (a.timestamp_us != b.timestamp_us) return a.timestamp_us < b.timestamp_us;
+		if (rank(a) != rank(b)) return rank(a) < rank(b);
+		if (a.duration_us != b.duration_us) return a.end ? a.duration_us < b.duration_us : a.duration_us > b.duration_us;
+		return a.end ? a.sequence < b.sequence : a.sequence > b.sequence;
+	});
+
+	Proto event, p;
+	for (auto&& edge : edges) {
+		event.data.clear();
+		if (edge.threadid == counter_thread) {
+			event.uint(TrackEvent_type, TYPE_COUNTER);
+			event.uint(TrackEvent_track_uuid, counter_uuid(edge.whatid));
+			event.f64(TrackEvent_double_counter_value, counter_value(edge.duration_us));
+		}
+		else {
+			event.uint(TrackEvent_type, edge.end ? TYPE_SLICE_END : TYPE_SLICE_BEGIN);
+			event.uint(TrackEvent_track_uuid, thread_uuid(edge.threadid));
+			if (!edge.end) event.uint(TrackEvent_name_iid, edge.whatid + 1);
+		}
 
-	catch (...) {
-		// sorry if this happens to you...
-		return result_Error_Failed;
+		p.data.clear();
+		p.uint(TracePacket_timestamp, edge.timestamp_us * 1000);
+		p.uint(TracePacket_sequence_id, sequence_id);
+		p.uint(TracePacket_sequence_flags, SEQ_NEEDS_INCREMENTAL_STATE);
+		p.message(TracePacket_track_event, event);
+		packet(p);
 	}
 
-	return result_Success;
+	return out.close() ? result_Success : result_Error_Failed;
 }
 
-void Session::init(int max_trace_count) noexcept
+// Turns events into .trace records, names are numbered as they show up
+struct Trace_Writer {
+	std::ofstream os;
+	std::unordered_map<char const*, uint32_t> names;
+	std::vector<Raw_Trace_Event> raw;
+
+	bool open(char const* filename) {
+		os.open(filename, std::ios::binary);
+		if (!os) return false;
+		os.write(trace_file::magic, sizeof(trace_file::magic));
+		_write_from(os, trace_file::version);
+		return true;
+	}
+
+	void record(trace_file::tag tag, void const* data, size_t size) {
+		trace_file::Record_Header header = { tag, (uint32_t)size };
+		_write_from(os, header);
+		os.write((char const*)data, size);
+	}
+
+	void thread_names(char const* names, int size) {
+		if (size > 0) record(trace_file::tag_Thread_Names, names, size);
+	}
+
+	uint32_t name_id(char const* what) {
+		auto [it, inserted] = names.try_emplace(what, (uint32_t)names.size());
+		if (inserted) {
+			size_t length = strlen(what);
+			trace_file::Record_Header header = { trace_file::tag_Name, uint32_t(sizeof(uint32_t) + length) };
+			_write_from(os, header);
+			_write_from(os, it->second);
+			os.write(what, length);
+		}
+		return it->second;
+	}
+
+	// events [begin, end) of `ring`, `mask` is capacity - 1 (all bits set when it is not a ring)
+	void events(Trace_Event const* ring, uint64_t mask, uint64_t begin, uint64_t end) {
+		// records are limited to 4 GiB
+		static constexpr uint64_t max_events_per_record = (1u << 24);
+
+		while (begin < end) {
+			uint64_t count = std::min(end - begin, max_events_per_record);
+			raw.resize(count);
+			for (uint64_t i = 0; i < count; ++i) {
+				auto const& trace = ring[(begin + i) & mask];
+				raw[i].whatid       = (uint16_t)name_id(trace.what);
+				raw[i].threadid     = trace.threadid;
+				raw[i].duration_us  = trace.duration_us;
+				raw[i].timestamp_us = trace.timestamp_us;
+			}
+			record(trace_file::tag_Events, raw.data(), count * sizeof(Raw_Trace_Event));
+			begin += count;
+		}
+	}
+};
+
+struct Session::Streamer {
+	Trace_Writer            writer;
+	std::thread             thread;
+	std::mutex              mutex;
+	std::condition_variable wake;
+	bool                    stop = false;
+	std::chrono::nanoseconds interval;
+};
+
+void Session::init(int max_trace_count, mode m, double ring_seconds) noexcept
 {
-	// TODO: make this allocation more portable?
-	trace_data = _aligned64_mallocT(max_trace_count, Trace_Event);
-	trace_count = trace_data ? max_trace_count : 0;
-	trace_occupied = 0;
+	uint32_t capacity = 64;
+	while (capacity < (uint32_t)max_trace_count) capacity <<= 1;
+
+	buffers.store(nullptr, std::memory_order_relaxed);
+	events_per_thread = capacity;
+	recording_mode = m;
+	ring_us = (uint64_t)(ring_seconds * 1'000'000.0);
+	id = s_next_id.fetch_add(1, std::memory_order_relaxed);
 
+	streamer = nullptr;
 	thread_names = nullptr;
 	thread_count = 0;
+	thread_names_size = 0;
 }
 
 void Session::uninit() noexcept
 {
-	if (trace_data) {
-		trace_count = 0;
-		_aligned_free(trace_data);
-		trace_data = nullptr;
+	stop_streaming();
+	id = 0;
+	auto buffer = buffers.exchange(nullptr, std::memory_order_acquire);
+	while (buffer) {
+		auto next = buffer->next;
+		aligned_free64(buffer->events);
+		buffer->~Thread_Buffer();
+		aligned_free64(buffer);
+		buffer = next;
 	}
 	if (thread_names) {
 		thread_count = 0;
@@ -274,14 +822,112 @@ void Session::uninit() noexcept
 	}
 }
 
-void Session::insert_event(Trace_Event const& event)
+Thread_Buffer* Session::register_thread()
+{
+	if (id == 0) return nullptr;
+
+	// make room in the cache, the oldest entry falls out
+	memmove(t_cache + 1, t_cache, sizeof(t_cache) - sizeof(Thread_Cache));
+
+	// remember failure too, so a thread does not try to allocate for every event
+	t_cache[0] = { id, nullptr };
+
+	// fell out of the cache earlier, the buffer is still in the list
+	auto const self = std::this_thread::get_id();
+	for (auto buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+		if (buffer->owner == self) return t_cache[0].buffer = buffer;
+	}
+
+	auto events = _aligned64_mallocT(events_per_thread, Trace_Event);
+	if (!events) return nullptr;
+
+	auto memory = aligned_alloc64(sizeof(Thread_Buffer));
+	if (!memory) {
+		aligned_free64(events);
+		return nullptr;
+	}
+
+	auto buffer = new (memory) Thread_Buffer;
+	buffer->events   = events;
+	buffer->capacity = events_per_thread;
+	buffer->written.store(0, std::memory_order_relaxed);
+	buffer->read.store(0, std::memory_order_relaxed);
+	buffer->owner    = self;
+
+	// the only time threads touch shared state
+	buffer->next = buffers.load(std::memory_order_relaxed);
+	while (!buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed));
+
+	t_cache[0].buffer = buffer;
+	return buffer;
+}
+
+void Session::reset()
+{
+	for (auto buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+		buffer->written.store(0, std::memory_order_relaxed);
+		buffer->read.store(0, std::memory_order_relaxed);
+	}
+}
+
+result Session::start_streaming(char const* filename, double flush_interval_seconds)
+{
+	if (recording_mode != mode_Fill || id == 0) return result_Error_Failed;
+	stop_streaming();
+
+	auto s = new Streamer;
+	if (!s->writer.open(filename)) {
+		delete s;
+		return result_Error_FailedToCreateFile;
+	}
+	s->writer.thread_names(thread_names, thread_names_size);
+	s->interval = std::chrono::nanoseconds((int64_t)(flush_interval_seconds * 1e9));
+
+	streamer = s;
+	s->thread = std::thread([this, s] {
+		std::unique_lock lock{s->mutex};
+		while (!s->stop) {
+			s->wake.wait_for(lock, s->interval);
+			lock.unlock();
+			flush_to_stream();
+			lock.lock();
+		}
+	});
+	return result_Success;
+}
+
+void Session::stop_streaming()
+{
+	if (!streamer) return;
+	{
+		std::scoped_lock lock{streamer->mutex};
+		streamer->stop = true;
+	}
+	streamer->wake.notify_one();
+	streamer->thread.join();
+
+	// whatever was recorded after the last flush
+	flush_to_stream();
+
+	delete streamer;
+	streamer = nullptr;
+}
+
+// Streaming thread, or after it has stopped
+void Session::flush_to_stream()
 {
-	auto next = PROFILER_INTERLOCKED_INC(trace_occupied) - 1;
-	if (next >= trace_count) {
-		PROFILER_INTERLOCKED_DEC(trace_occupied);
-		return;
+	auto& writer = streamer->writer;
+	for (auto buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+		uint64_t end   = buffer->written.load(std::memory_order_acquire);
+		uint64_t begin = buffer->read.load(std::memory_order_relaxed);
+		if (begin == end) continue;
+
+		writer.events(buffer->events, buffer->capacity - 1, begin, end);
+
+		// hand the slots back to the recording thread
+		buffer->read.store(end, std::memory_order_release);
 	}
-	trace_data[next] = event;
+	writer.os.flush();
 }
 
 namespace helper {
@@ -291,14 +937,6 @@ namespace helper {
 			if (*src++ == 0) break;
 		}
 	}
-	template <typename T> struct buffer_view {
-		T const* data;
-		size_t count;
-
-		buffer_view(T const* data, size_t count): data(data), count(count) {}
-		T const* begin() const { return data; }
-		T const* end  () const { return data + count; }
-	};
 }
 
 void Session::name_threads(char const** ptr_thread_name_strings, int count)
@@ -321,134 +959,85 @@ void Session::name_threads(char const** ptr_thread_name_strings, int count)
 
 void Session::save(char const* filename)
 {
-	using f = std::ios;
-
-	// create hash table for our "function names"
-	std::unordered_map<char const*, int> map;
-	std::vector<char const*> what_array;
-	{
-		what_array.reserve(32);
-		map.reserve(32);
-		int count = 0;
-		for (auto&& trace : helper::buffer_view(trace_data, trace_occupied)) {
-			auto it = map.find(trace.what);
-			if (it == map.end()) {
-				map.insert({ trace.what, count++ });
-				what_array.emplace_back(trace.what);
+	// copy every thread's events, the oldest that are still around in ring mode
+	std::vector<Trace_Event> events;
+	for (auto buffer = buffers.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+		uint64_t end   = buffer->written.load(std::memory_order_acquire);
+		uint64_t begin = (end > buffer->capacity) ? end - buffer->capacity : 0;
+		if (recording_mode == mode_Fill) begin = buffer->read.load(std::memory_order_acquire);
+
+		size_t first = events.size();
+		for (uint64_t i = begin; i < end; ++i)
+			events.emplace_back(buffer->events[i & (buffer->capacity - 1)]);
+
+		// the thread kept going while we copied, anything it wrote over is garbage
+		if (recording_mode == mode_Ring) {
+			uint64_t now = buffer->written.load(std::memory_order_acquire);
+			uint64_t overwritten = (now > buffer->capacity) ? now - buffer->capacity : 0;
+			if (overwritten > begin) {
+				auto count = (size_t)std::min(overwritten - begin, end - begin);
+				events.erase(events.begin() + first, events.begin() + first + count);
 			}
 		}
 	}
 
-	auto temp = _aligned64_mallocT(trace_occupied, Raw_Trace_Event);
-	if (temp == nullptr) throw std::bad_alloc();
-
-	// Fill our raw buffer
-	auto pCurrent = temp;
-	for (auto&& trace : helper::buffer_view(trace_data, trace_occupied)) {
-		pCurrent->whatid = map[trace.what];
-		pCurrent->threadid = trace.threadid;
-		pCurrent->duration_us = trace.duration_us;
-		pCurrent->timestamp_us = trace.timestamp_us;
-		++pCurrent;
+	// only keep the last `ring_us` of events
+	if (recording_mode == mode_Ring && ring_us) {
+		uint64_t newest = 0;
+		for (auto&& event : events) newest = std::max(newest, event_end_us(event));
+		uint64_t oldest = (newest > ring_us) ? newest - ring_us : 0;
+		std::erase_if(events, [oldest](Trace_Event const& e) { return event_end_us(e) < oldest; });
 	}
 
-	// finally write to file
-	if (auto os = std::ofstream(filename, f::binary)) {
-
-		// First write our strings
-		uint32_t count = (uint32_t)what_array.size();
-		_write_from(os, count);
-		for (auto&& what : what_array) {
-			os << what << '\0';
-		}
+	Trace_Writer writer;
+	if (!writer.open(filename)) return;
 
-		// Second write our thread names
-		_write_from(os, thread_count);
-		if (thread_count > 0) {
-			os.write(thread_names, thread_names_size);
-		}
-
-		// Third write the raw trace data
-		uint32_t event_count = trace_occupied;
-		_write_from(os, event_count);
-		os.write((char*)temp, event_count * sizeof(Raw_Trace_Event));
-	}
-
-	_aligned_free(temp);
+	writer.thread_names(thread_names, thread_names_size);
+	writer.events(events.data(), ~uint64_t(0), 0, events.size());
 }
 
 #undef _aligned64_mallocT
-#undef _read_into
 #undef _write_from
-#undef _u64_to_str
 
 #endif // PROFILER_IMPLEMENTATION
 
 #ifndef PROFILER_NO_SCOPED_TRACE
-#define microseconds(TS) ((TS.QuadPart*1000000)/s_Frequency.QuadPart)
-// Windows Only (for now...)
 struct scoped_trace {
 	Session* session;
 	char const* what;
 	uint16_t threadid;
-	LARGE_INTEGER start;
-
-	static inline LARGE_INTEGER s_Frequency = {1};
-	static inline LARGE_INTEGER s_PrevStart;
-	static inline LARGE_INTEGER s_PrevEnd;
+	uint64_t start_us;
+
+	// per thread, so that threads do not fight over these
+	static inline thread_local uint64_t s_PrevStart = 0;
+	static inline thread_local uint64_t s_PrevEnd   = 0;
+
+	// Ensure no two start (or end) times are the same,
+	//  chrome tracing gets the nesting wrong otherwise
+	static uint64_t unique_us(uint64_t& prev) {
+		uint64_t us;
+		do us = timestamp_ns() / 1000;
+		while (us == prev);
+		prev = us;
+		return us;
+	}
 
 	scoped_trace(profiler::Session* session, int threadid, char const* what) :
-		session(session), threadid(threadid), what(what)
+		session(session), what(what), threadid((uint16_t)threadid)
 	{
-	last_resort: // this is my last resort
-		QueryPerformanceCounter(&start);
-
-		// Ensure no two start times are the same
-		if (microseconds(start) == microseconds(s_PrevStart))
-			goto last_resort;
-		//	start.QuadPart += s_Frequency.QuadPart / 1'000'000;
-
-		s_PrevStart = start;
+		start_us = unique_us(s_PrevStart);
 	}
 	~scoped_trace() {
-		LARGE_INTEGER end, ElapsedMicroseconds;
-	last_resort:
-		QueryPerformanceCounter(&end);
-
-		// Ensure no two end times are the same
-		if (microseconds(end) == microseconds(s_PrevEnd))
-			goto last_resort;
-		//	end.QuadPart += 4*s_Frequency.QuadPart / 1'000'000;
-
-		s_PrevEnd = end;
-
-		ElapsedMicroseconds.QuadPart = end.QuadPart - start.QuadPart;
-
-		// Convert to microseconds
-		ElapsedMicroseconds.QuadPart *= 1'000'000;
-		ElapsedMicroseconds.QuadPart /= s_Frequency.QuadPart;
+		uint64_t elapsed = unique_us(s_PrevEnd) - start_us;
 
 		uint32_t duration;
-		if (ElapsedMicroseconds.QuadPart > UINT32_MAX) {
+		if (elapsed > UINT32_MAX) {
 			duration = UINT32_MAX;
 		}
-		else duration = static_cast<uint32_t>(ElapsedMicroseconds.QuadPart);
+		else duration = static_cast<uint32_t>(elapsed);
 
-		session->insert_event({ what, threadid, duration, (unsigned)(microseconds(start)) });
-	//	session->insert_event({ what, threadid, duration, (unsigned)(start.QuadPart) });
-	}
-private:
-	static void init() {
-		QueryPerformanceFrequency(&s_Frequency);
-		s_PrevStart.QuadPart = 0;
-		s_PrevEnd.QuadPart = 0;
+		session->insert_event({ what, threadid, duration, start_us });
 	}
-
-	struct doinit {
-		doinit() { scoped_trace::init(); }
-	};
-	static inline doinit _doinit;
-#undef microseconds
 };
 #endif // !PROFILER_NO_SCOPED_TRACE
 
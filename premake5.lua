@@ -68,6 +68,11 @@ else
 	FISSION_LINKS["vulkan"]="%{VULKAN_SDK}/lib"
 end
 
+newoption {
+	trigger     = "track-allocations",
+	description = "Debug builds keep track of every FISSION_DEFAULT_ALLOC and report leaks on exit"
+}
+
 if FISSION_EXTERNAL then
 	include 'Fission'
 else
@@ -80,9 +85,18 @@ else
         defines '_CRT_SECURE_NO_WARNINGS'
     end
 
+	if _OPTIONS["track-allocations"] then
+		filter "configurations:Debug"
+			defines "FISSION_TRACK_ALLOCATIONS"
+		filter {}
+	end
+
 	FISSION_LOCATION = '%{wks.location}'
 	startproject 'sandbox'
 	
 	include 'Fission'
 	include 'sandbox'
+	include 'tools/trace_convert'
+	include 'tools/bench'
+	include 'tools/base_bench'
 end
@@ -523,7 +523,7 @@ struct Scene_OK : public fs::Scene {
 		engine.textured_renderer_2d.set_font(&engine.fonts.console);
 		{
 			auto s = engine.textured_renderer_2d.add_string(text, {}, colors::Lime);
-			engine.renderer_2d.add_rect(rf32::from_topleft(s.x, 0.0f, engine.fonts.console.table.fallback.advance, engine.fonts.console.height), colors::Lime);
+			engine.renderer_2d.add_rect(rf32::from_topleft(s.x, 0.0f, engine.fonts.console.table.fallback().advance, engine.fonts.console.height), colors::Lime);
 		}
 
 		auto& cmd = ctx->command_buffer;
@@ -619,7 +619,7 @@ struct Scene_OK : public fs::Scene {
 			vkCreateImageView(gfx.device, &viewInfo, nullptr, &dst_view);
 
 			auto const stride = vk::size_of(format);
-			auto data = FISSION_DEFAULT_ALLOC(imageInfo.extent.width * imageInfo.extent.height * stride);
+			auto data = FISSION_TAGGED_ALLOC(imageInfo.extent.width * imageInfo.extent.height * stride, scene);
 			memset(data, 0, imageInfo.extent.width * imageInfo.extent.height * stride);
 #ifdef THIRD_PASS
 			gfx.upload_image(dst_image, data, imageInfo.extent, format);
@@ -0,0 +1,31 @@
+-- Microbenchmarks for include/Fission/Base, `-check thresholds.txt` fails on regressions
+project 'base_bench'
+    kind 'ConsoleApp'
+    language 'C++'
+    cppdialect "c++20"
+
+    targetdir ("%{wks.location}/bin/" .. output_location)
+	objdir ("%{wks.location}/bin-int/" .. output_location .. "/%{prj.name}")
+
+	-- Base is mostly headers, only the sources it needs are built in, no need to link with Fission
+    files {
+		"%{prj.location}/src/*.cpp",
+		"%{FISSION_LOCATION}/Fission/src/Platform/String.cpp",
+		"%{FISSION_LOCATION}/Fission/src/Memory_Tracker.cpp",
+	}
+
+	includedirs {
+		'%{FISSION_LOCATION}/include',
+		'%{FISSION_LOCATION}/Fission/src', -- Scene_Key_Parser.hpp
+	}
+
+    staticruntime "On"
+
+    filter "configurations:Debug"
+        symbols "On"
+
+    filter "configurations:Release"
+        optimize "On"
+
+    filter "configurations:Dist"
+        optimize "Speed"
@@ -0,0 +1,395 @@
+#include <Fission/Base/Color.hpp>
+#include <Fission/Base/Math/Matrix.hpp>
+#include <Fission/Base/String.hpp>
+#include <Fission/Base/Memory.hpp>
+#include <Fission/Base/Dynamic_Array.hpp>
+#include <Fission/Core/Scene.hh>
+#include "Scene_Key_Parser.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// base_bench [<filter>] [-check <thresholds>] [-save <thresholds>] [-time <ms>]
+//  filter          only benchmarks with this in their name
+//  -check <file>   fail (exit code 1) when a benchmark is slower than its limit in the file
+//  -save <file>    write limits from this run, `margin` times what was measured
+//  -time <ms>      time spent on every benchmark, 200 by default
+//
+// Every benchmark does the same amount of work each call, ns/op is per item (a color,
+//  a matrix, a string, an allocation), bytes/s is the input it got through.
+
+using namespace fs;
+
+// Keeps the compiler from throwing away results that are never read
+template <typename T>
+static void keep(T const& value) {
+#if defined(_MSC_VER)
+	static volatile char sink;
+	sink = *reinterpret_cast<char const volatile*>(&value);
+#else
+	asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+struct Result {
+	std::string name;
+	double      ns_per_op;
+	double      bytes_per_second; // 0 when the benchmark has no input to speak of
+};
+
+struct Runner {
+	static constexpr int    samples = 7;
+	static constexpr double margin  = 3.0; // limits written by -save, noise between runs is way under this
+
+	char const*         filter = nullptr;
+	double              seconds = 0.2;
+	std::vector<Result> results;
+
+	// `fn(calls)` does `items` items (taking in `bytes`) per call
+	template <typename F>
+	void run(char const* name, u64 items, u64 bytes, F&& fn) {
+		if (filter && !strstr(name, filter)) return;
+
+		using clock = std::chrono::steady_clock;
+		auto time = [&](u64 calls) {
+			auto start = clock::now();
+			fn(calls);
+			return std::chrono::duration<double>(clock::now() - start).count();
+		};
+
+		// enough calls that the clock is not what gets measured
+		u64 calls = 1;
+		double t = time(calls);
+		while (t < 0.001 && calls < (u64(1) << 40)) {
+			calls *= (t < 0.0001) ? 10 : 2;
+			t = time(calls);
+		}
+		calls = max(u64(1), u64(double(calls) * (seconds / samples) / t));
+
+		// median, a sample that got preempted does not move it
+		double times[samples];
+		FS_FOR(samples) times[i] = time(calls);
+		std::sort(times, times + samples);
+		double per_call = times[samples / 2] / double(calls);
+
+		Result r = {
+			.name             = name,
+			.ns_per_op        = per_call * 1e9 / double(items),
+			.bytes_per_second = bytes ? double(bytes) / per_call : 0.0,
+		};
+
+		if (r.bytes_per_second > 0.0) printf("%-32s %10.2f ns/op %10.1f MB/s\n", name, r.ns_per_op, r.bytes_per_second / 1e6);
+		else                          printf("%-32s %10.2f ns/op\n", name, r.ns_per_op);
+		results.emplace_back(std::move(r));
+	}
+};
+
+// Deterministic, every run sees the same data
+struct Random {
+	u64 state = 0x9E3779B97F4A7C15ull;
+	u32 next() {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		return u32(state >> 32);
+	}
+	float unit() { return float(next() >> 8) * (1.0f / 16777216.0f); }
+};
+
+// ---------------------------------------------------------------------------------------------
+// Color.hpp, a 64x64 texture worth of colors
+
+static void bench_color(Runner& r) {
+	static constexpr u32 count = 64 * 64;
+	Random random;
+
+	std::vector<rgb>   in_rgb(count);
+	std::vector<hsv>   in_hsv(count);
+	std::vector<hsl>   in_hsl(count);
+	std::vector<rgba8> in_rgba8(count);
+	std::vector<rgba>  in_rgba(count);
+	FS_FOR(count) {
+		in_rgb[i]   = rgb{random.unit(), random.unit(), random.unit()};
+		in_hsv[i]   = hsv{random.unit(), random.unit(), random.unit()};
+		in_hsl[i]   = hsl{random.unit(), random.unit(), random.unit()};
+		in_rgba8[i] = rgba8{u8(random.next()), u8(random.next()), u8(random.next()), u8(random.next())};
+		in_rgba[i]  = rgba{random.unit(), random.unit(), random.unit(), random.unit()};
+	}
+
+	std::vector<rgb>   out_rgb(count);
+	std::vector<hsv>   out_hsv(count);
+	std::vector<hsl>   out_hsl(count);
+	std::vector<rgba>  out_rgba(count);
+	std::vector<rgba8> out_rgba8(count);
+
+	r.run("color/rgb_to_hsv", count, count * sizeof(rgb), [&](u64 calls) {
+		while (calls--) { FS_FOR(count) out_hsv[i] = (hsv)in_rgb[i]; keep(out_hsv[0]); }
+	});
+	r.run("color/hsv_to_rgb", count, count * sizeof(hsv), [&](u64 calls) {
+		while (calls--) { FS_FOR(count) out_rgb[i] = (rgb)in_hsv[i]; keep(out_rgb[0]); }
+	});
+	r.run("color/rgb_to_hsl", count, count * sizeof(rgb), [&](u64 calls) {
+		while (calls--) { FS_FOR(count) out_hsl[i] = (hsl)in_rgb[i]; keep(out_hsl[0]); }
+	});
+	r.run("color/hsl_to_rgb", count, count * sizeof(hsl), [&](u64 calls) {
+		while (calls--) { FS_FOR(count) out_rgb[i] = (rgb)in_hsl[i]; keep(out_rgb[0]); }
+	});
+	r.run("color/rgba8_to_rgba", count, count * sizeof(rgba8), [&](u64 calls) {
+		while (calls--) { FS_FOR(count) out_rgba[i] = (rgba)in_rgba8[i]; keep(out_rgba[0]); }
+	});
+	r.run("color/rgba_to_rgba8", count, count * sizeof(rgba), [&](u64 calls) {
+		while (calls--) { FS_FOR(count) out_rgba8[i] = (rgba8)in_rgba[i]; keep(out_rgba8[0]); }
+	});
+}
+
+// ---------------------------------------------------------------------------------------------
+// Math/Matrix.hpp, transforms for a frame of sprites and vertices
+
+static void bench_matrix(Runner& r) {
+	static constexpr u32 count = 1024;
+	Random random;
+
+	std::vector<m44> a(count), b(count), out(count);
+	std::vector<m23> a23(count), b23(count), out23(count);
+	std::vector<m44::vector> v4(count * 4), out_v4(count * 4);
+	std::vector<m23::vector> v2(count * 4), out_v2(count * 4);
+
+	FS_FOR(count) {
+		a[i]   = m44::Translation(random.unit(), random.unit(), random.unit()) * m44::RotationZ(random.unit() * 6.28f);
+		b[i]   = m44::Scaling(random.unit(), random.unit(), random.unit()) * m44::RotationX(random.unit() * 6.28f);
+		a23[i] = m23::Translation(random.unit() * 1280.0f, random.unit() * 720.0f) * m23::Rotation(random.unit() * 6.28f);
+		b23[i] = m23::Scaling(random.unit() + 0.5f, random.unit() + 0.5f);
+	}
+	FS_FOR(count * 4) {
+		v4[i] = m44::vector(random.unit(), random.unit(), random.unit(), 1.0f);
+		v2[i] = m23::vector(random.unit() * 64.0f, random.unit() * 64.0f);
+	}
+
+	r.run("matrix/m44_mul_m44", count, count * 2 * sizeof(m44), [&](u64 calls) {
+		while (calls--) { FS_FOR(count) out[i] = a[i] * b[i]; keep(out[0]); }
+	});
+	r.run("matrix/m44_mul_v4", count * 4, count * 4 * sizeof(m44::vector), [&](u64 calls) {
+		while (calls--) { FS_FOR(count * 4) out_v4[i] = a[i / 4] * v4[i]; keep(out_v4[0]); }
+	});
+	r.run("matrix/m44_transpose", count, count * sizeof(m44), [&](u64 calls) {
+		while (calls--) { FS_FOR(count) out[i] = a[i].transpose(); keep(out[0]); }
+	});
+	r.run("matrix/m23_mul_m23", count, count * 2 * sizeof(m23), [&](u64 calls) {
+		while (calls--) { FS_FOR(count) out23[i] = a23[i] * b23[i]; keep(out23[0]); }
+	});
+	r.run("matrix/m23_mul_v2", count * 4, count * 4 * sizeof(m23::vector), [&](u64 calls) {
+		while (calls--) { FS_FOR(count * 4) out_v2[i] = a23[i / 4] * v2[i]; keep(out_v2[0]); }
+	});
+}
+
+// ---------------------------------------------------------------------------------------------
+// convert_utf8_to_utf16, window titles and pasted text
+
+static std::string make_text(u64 size, bool ascii_only) {
+	static constexpr char const* words[] = {
+		"the ", "quick ", "brown ", "fox ", "jumps ", "over ", "lazy ", "dog ", "0123 ",
+		"reflexões ", "出展 ", "うこそ ", "Straße ", "😭 ",
+	};
+	u64 const word_count = ascii_only ? 9 : std::size(words);
+
+	Random random;
+	std::string s;
+	while (s.size() < size) s += words[random.next() % word_count];
+
+	// cut on a character boundary
+	s.resize(size);
+	while (!s.empty() && (u8(s.back()) & 0xC0) == 0x80) s.pop_back();
+	if (!s.empty() && (u8(s.back()) & 0x80)) s.pop_back();
+	return s;
+}
+
+static void bench_utf8(Runner& r) {
+	struct Input { char const* name; u64 size; bool ascii; };
+	static constexpr Input inputs[] = {
+		{ "utf8_to_utf16/title_ascii", 48,             true  },
+		{ "utf8_to_utf16/title_mixed", 48,             false },
+		{ "utf8_to_utf16/64k_ascii",   FS_KILOBYTES(64), true  },
+		{ "utf8_to_utf16/64k_mixed",   FS_KILOBYTES(64), false },
+	};
+
+	for (auto&& in : inputs) {
+		auto text = make_text(in.size, in.ascii);
+		std::vector<c16> buffer(text.size());
+
+		string source = FS_str_make(text.data(), text.size());
+		r.run(in.name, 1, text.size(), [&](u64 calls) {
+			while (calls--) {
+				string_utf16 out = {.count = 0, .data = buffer.data()};
+				convert_utf8_to_utf16(&out, source);
+				keep(out.count);
+			}
+		});
+	}
+}
+
+// ---------------------------------------------------------------------------------------------
+// Scene_Key, parsed once per command line or scene change, read by every scene
+
+static void bench_scene_key(Runner& r) {
+	static constexpr char const* command_lines[] = {
+		"Level",
+		"Level -level_id 69 -difficulty 0.75 -name \"first level\" -fullscreen",
+		"r2d_replay -file captures/menu.fr2d -loops 10 -quit -scale 1.5 -seed 123456789 -title reflexões -debug",
+	};
+	static constexpr char const* names[] = { "scene_key/parse_name", "scene_key/parse_short", "scene_key/parse_long" };
+
+	FS_FOR(std::size(command_lines)) {
+		string input = FS_str_make(command_lines[i], strlen(command_lines[i]));
+		std::vector<u8> stream;
+		r.run(names[i], 1, input.count, [&](u64 calls) {
+			while (calls--) {
+				stream.clear();
+				Scene_Key_Parser parser{input};
+				parser.parse(stream);
+				keep(stream.data()[0]);
+			}
+		});
+	}
+
+	Scene_Key key;
+	Scene_Key_Parser{FS_str_make(command_lines[2], strlen(command_lines[2]))}.parse(key.stream);
+	r.run("scene_key/iterate", 1, key.stream.size(), [&](u64 calls) {
+		while (calls--) {
+			u64 found = 0;
+			for (auto [name, value] : key) found += name.count + value.type;
+			keep(found);
+		}
+	});
+}
+
+// ---------------------------------------------------------------------------------------------
+// bump_allocator, the 2D renderers carve their arrays out of one
+
+static void bench_bump_allocator(Runner& r) {
+	static constexpr u64 capacity = FS_KILOBYTES(64);
+	bump_allocator allocator{capacity};
+
+	r.run("bump_allocator/alloc_16", capacity / 16, capacity, [&](u64 calls) {
+		while (calls--) {
+			allocator.bytes_allocated = 0;
+			while (void* p = allocator.alloc(16)) keep(p);
+		}
+	});
+	r.run("bump_allocator/alloc_vertex", capacity / 20, capacity, [&](u64 calls) {
+		struct vertex { float x, y; u8 r, g, b, a; float u, v; }; // 20 bytes, like the textured renderer
+		while (calls--) {
+			allocator.bytes_allocated = 0;
+			while (auto p = allocator.alloc<vertex>(1)) keep(p);
+		}
+	});
+}
+
+// ---------------------------------------------------------------------------------------------
+// dynamic_array, growing from nothing and growing from a good guess
+
+static void bench_dynamic_array(Runner& r) {
+	static constexpr u32 count = 4096;
+
+	r.run("dynamic_array/push_back", count, count * sizeof(u32), [&](u64 calls) {
+		while (calls--) {
+			dynamic_array<u32> a;
+			FS_FOR(count) a.push_back(u32(i));
+			keep(a.data[count - 1]);
+			FISSION_DEFAULT_FREE(a.data);
+		}
+	});
+	r.run("dynamic_array/push_back_reserved", count, count * sizeof(u32), [&](u64 calls) {
+		while (calls--) {
+			dynamic_array<u32> a{count};
+			FS_FOR(count) a.push_back(u32(i));
+			keep(a.data[count - 1]);
+			FISSION_DEFAULT_FREE(a.data);
+		}
+	});
+	r.run("dynamic_array/string_array", 256, 256 * 12, [&](u64 calls) {
+		static constexpr char word[] = "console_cmd";
+		while (calls--) {
+			string_array strings;
+			FS_FOR(256) strings.insert_string(FS_str(word));
+			keep(strings.buffer.count);
+			FISSION_DEFAULT_FREE(strings.buffer.data);
+		}
+	});
+}
+
+// ---------------------------------------------------------------------------------------------
+// Thresholds: "<name> <ns/op>" per line, '#' starts a comment
+
+static bool check(Runner const& r, char const* filename) {
+	FILE* file = fopen(filename, "rb");
+	if (!file) {
+		fprintf(stderr, "could not open \"%s\"\n", filename);
+		return false;
+	}
+
+	bool ok = true;
+	u32 checked = 0;
+	char line[256];
+	while (fgets(line, sizeof(line), file)) {
+		char name[128];
+		double limit;
+		if (line[0] == '#' || sscanf(line, "%127s %lf", name, &limit) != 2) continue;
+
+		for (auto&& result : r.results) {
+			if (result.name != name) continue;
+			++checked;
+			if (result.ns_per_op > limit) {
+				printf("REGRESSION %s: %.2f ns/op, limit is %.2f\n", name, result.ns_per_op, limit);
+				ok = false;
+			}
+		}
+	}
+	fclose(file);
+
+	printf("%u checked against \"%s\", %s\n", checked, filename, ok ? "all within limits" : "some over their limit");
+	return ok;
+}
+
+static bool save(Runner const& r, char const* filename) {
+	FILE* file = fopen(filename, "wb");
+	if (!file) {
+		fprintf(stderr, "could not write \"%s\"\n", filename);
+		return false;
+	}
+	fprintf(file, "# ns/op limits for `base_bench -check`, %.0fx what the machine that wrote them measured\n", Runner::margin);
+	fprintf(file, "# only mean something for a Release build on a similar machine, `base_bench -save` writes new ones\n");
+	for (auto&& result : r.results) fprintf(file, "%-32s %.2f\n", result.name.c_str(), result.ns_per_op * Runner::margin);
+	fclose(file);
+	return true;
+}
+
+int main(int argc, char** argv) {
+	Runner runner;
+	char const* check_file = nullptr;
+	char const* save_file  = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+		if      (strcmp(argv[i], "-check") == 0 && i + 1 < argc) check_file = argv[++i];
+		else if (strcmp(argv[i], "-save")  == 0 && i + 1 < argc) save_file  = argv[++i];
+		else if (strcmp(argv[i], "-time")  == 0 && i + 1 < argc) runner.seconds = max(atof(argv[++i]), 1.0) / 1000.0;
+		else if (argv[i][0] != '-') runner.filter = argv[i];
+		else {
+			fprintf(stderr, "usage: %s [<filter>] [-check <thresholds>] [-save <thresholds>] [-time <ms>]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	bench_color(runner);
+	bench_matrix(runner);
+	bench_utf8(runner);
+	bench_scene_key(runner);
+	bench_bump_allocator(runner);
+	bench_dynamic_array(runner);
+
+	if (save_file && !save(runner, save_file)) return 1;
+	if (check_file && !check(runner, check_file)) return 1;
+	return 0;
+}
@@ -0,0 +1,7 @@
+-- Runs scenes offscreen for a fixed number of frames and writes the timings as JSON
+fission_project 'fission-bench'
+
+-- no window, output goes to the terminal
+kind 'ConsoleApp'
+
+files { "%{prj.location}/src/**.cpp" }
@@ -0,0 +1,363 @@
+#include <Fission/Core/Engine.hh>
+#include <Fission/Core/Scene.hh>
+#include <Fission/Core/Console.hh>
+#include <Fission/Core/Renderer_2D_Capture.hh>
+#include <Fission/Core/Input/Keys.hh>
+#include <Fission/Base/Time.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// fission-bench [<case>|all] [-frames <n>] [-warmup <n>] [-dt <seconds>] [-out <file>] [-replay <capture>]
+//
+// Every case is a scene that runs for `warmup + frames` frames offscreen. Scenes see the same
+//  dt every frame and get the same events on the same frames, so every run draws the same thing
+//  and only the timings change. Timings of the last `frames` frames are written to `out` as JSON.
+
+extern fs::Engine engine;
+
+using namespace fs;
+
+// Events for `frame` (counted from the start of the case, warmup included),
+//  they get to the layers and the scene on the frame after
+using Script = void(*)(u32 frame, Event_Queue& queue);
+
+struct Bench_Case {
+	char const* name;
+	Scene*    (*create)(Scene_Key const& options);
+	Script      script;
+};
+
+static void key_down(Event_Queue& queue, u32 key) {
+	Event e = {};
+	e.timestamp = timestamp();
+	e.type = Event_Key_Down;
+	e.key_down.key_id = key;
+	queue.append(e);
+}
+
+static void character(Event_Queue& queue, c32 codepoint) {
+	Event e = {};
+	e.timestamp = timestamp();
+	e.type = Event_Character_Input;
+	e.character_input.codepoint = codepoint;
+	queue.append(e);
+}
+
+// Clears the screen, cases draw on top of that
+struct Clear_Scene : public Scene {
+	Render_Pass rp;
+	double      time = 0.0; // only ever moves by the fixed dt
+
+	Clear_Scene(char const* name) {
+		rp.name = name;
+		rp.create(VK_SAMPLE_COUNT_1_BIT, true);
+	}
+	~Clear_Scene() override {
+		rp.destroy();
+	}
+};
+
+// A screen full of solid rects, one draw call
+struct Rects_Scene : public Clear_Scene {
+	static constexpr u32 columns = 64;
+	static constexpr u32 rows    = 36;
+
+	Rects_Scene(): Clear_Scene("bench rects") {}
+
+	void on_update(double dt, std::vector<Event> const& events, Render_Context* ctx) override {
+		time += dt;
+
+		auto& r2d = engine.renderer_2d;
+		float w = (float)engine.graphics.sc_extent.width  / columns;
+		float h = (float)engine.graphics.sc_extent.height / rows;
+
+		FS_FOR(columns * rows) {
+			float x = float(i % columns), y = float(i / columns);
+			float hue = x / columns + y / rows * 0.5f + (float)time * 0.25f;
+			hue -= std::floor(hue);
+			r2d.add_rect({x * w + 1.0f, (x + 1.0f) * w - 1.0f, y * h + 1.0f, (y + 1.0f) * h - 1.0f}, color(rgb(hsv(hue, 0.6f, 0.9f))));
+		}
+
+		rp.begin(ctx, colors::Black);
+		engine.bind_font(ctx->command_buffer, &engine.fonts.debug); // transform
+		r2d.draw(*ctx);
+		rp.end(ctx);
+	}
+};
+
+// Lines of text that scroll sideways, every glyph is a textured quad
+struct Text_Scene : public Clear_Scene {
+	Text_Scene(): Clear_Scene("bench text") {}
+
+	void on_update(double dt, std::vector<Event> const& events, Render_Context* ctx) override {
+		time += dt;
+
+		auto& tr2d = engine.textured_renderer_2d;
+		tr2d.set_font(&engine.fonts.debug);
+
+		float height = (float)engine.fonts.debug.height;
+		float scroll = std::fmod((float)time * 60.0f, 200.0f);
+		u32   line = 0;
+		for (float y = 0.0f; y + height <= (float)engine.graphics.sc_extent.height; y += height, ++line) {
+			char temp[96];
+			auto s = "%04u the quick brown fox jumps over the lazy dog 0123456789 %.3f"_fmt(temp, line, time);
+			tr2d.add_string(s, {(line & 1) ? scroll : 200.0f - scroll, y}, colors::White);
+		}
+
+		rp.begin(ctx, colors::Black);
+		engine.bind_font(ctx->command_buffer, &engine.fonts.debug);
+		tr2d.draw(*ctx);
+		rp.end(ctx);
+	}
+};
+
+static Scene* create_rects(Scene_Key const&) { return new Rects_Scene; }
+static Scene* create_text (Scene_Key const&) { return new Text_Scene; }
+
+// Debug overlay shown (the console would hide it)
+static void overlay_script(u32 frame, Event_Queue& queue) {
+	if (frame == 0) key_down(queue, keys::F3);
+}
+
+// Console shown, a command typed one character per frame and run
+static void console_script(u32 frame, Event_Queue& queue) {
+	static constexpr char command[] = "stats\r";
+
+	if (frame == 0) {
+		key_down(queue, keys::F1);
+		return;
+	}
+	character(queue, (c32)command[(frame - 1) % (std::size(command) - 1)]);
+}
+
+// Frames of a capture (see `r2d_capture`), drawn exactly as they were recorded
+static Scene* create_replay(Scene_Key const& options) {
+	for (auto [name, value] : options) {
+		if (name == "replay" && value.type == Scene_Key::Value::String) {
+			Scene_Key key;
+			key.reset(FS_str("r2d_replay"));
+			key.add_string(FS_str("file"), value.v_string);
+			return r2d_capture::create_replay_scene(key);
+		}
+	}
+	return nullptr;
+}
+
+static Bench_Case const bench_cases[] = {
+	{ "rects",   create_rects,  nullptr        },
+	{ "text",    create_text,   nullptr        },
+	{ "overlay", create_rects,  overlay_script },
+	{ "console", create_rects,  console_script },
+	{ "replay",  create_replay, nullptr        }, // only with -replay
+};
+
+// Every measured frame, sorted at the end so the percentiles are exact
+struct Series {
+	std::vector<float> ms;
+
+	void write(std::string& json, char const* name) {
+		char temp[256];
+		if (ms.empty()) {
+			json += "\"%s\": null"_fmt(temp, name).str();
+			return;
+		}
+
+		std::sort(ms.begin(), ms.end());
+		double sum = 0.0;
+		for (float t : ms) sum += t;
+
+		// nearest rank
+		auto at = [&](double q) {
+			auto rank = (size_t)std::ceil(q * (double)ms.size());
+			return ms[rank ? rank - 1 : 0];
+		};
+		json += "\"%s\": {\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"mean\": %.4f}"_fmt(temp,
+			name, at(0.50), at(0.95), at(0.99), ms.back(), sum / ms.size()).str();
+	}
+};
+
+static void append_escaped(std::string& json, std::string_view s) {
+	json += '"';
+	for (char c : s) {
+		if (c == '"' || c == '\\') json += '\\';
+		if ((unsigned char)c >= 0x20) json += c;
+	}
+	json += '"';
+}
+
+struct Bench_Scene : public Scene {
+	Scene_Key   options;
+	std::string filter; // case name, empty runs all of them
+	std::string out = "bench.json";
+	u32         frames = 600;
+	u32         warmup = 60;
+	bool        replay = false; // -replay was given
+
+	u32    index = 0;       // case running, or next to run
+	u32    frame = 0;       // frames into the case
+	Scene* scene = nullptr;
+	s64    last  = 0;
+	u32    layer_flags[2];  // debug and console, put back after every case
+	u32    failed = 0;
+
+	Series cpu, frame_time, gpu;
+	std::string cases_json;
+
+	void on_update(double dt, std::vector<Event> const& events, Render_Context* ctx) override;
+	bool start_case();
+	void end_case();
+	void finish();
+
+	~Bench_Scene() override {
+		if (!scene) return;
+		vkDeviceWaitIdle(engine.graphics.device);
+		delete scene;
+	}
+};
+
+bool Bench_Scene::start_case() {
+	auto const& c = bench_cases[index];
+	if (!filter.empty() && filter != c.name) return false;
+	if (c.create == create_replay && !replay) return false;
+
+	scene = c.create(options);
+	if (!scene) {
+		console::printf(colors::Red, "bench: \"%s\" failed to start\n", c.name);
+		++failed;
+		return false;
+	}
+
+	frame = 0;
+	layer_flags[0] = engine.debug_layer.flags;
+	layer_flags[1] = engine.console_layer.flags;
+	for (auto s : {&cpu, &frame_time, &gpu}) {
+		s->ms.clear();
+		s->ms.reserve(frames);
+	}
+	console::printf(colors::White, "bench: %s\n", c.name);
+	return true;
+}
+
+void Bench_Scene::end_case() {
+	// last frame that used the scene has to be done first
+	vkDeviceWaitIdle(engine.graphics.device);
+	delete scene;
+	scene = nullptr;
+
+	engine.debug_layer.flags   = layer_flags[0];
+	engine.console_layer.flags = layer_flags[1];
+
+	auto name = bench_cases[index].name;
+	if (!cases_json.empty()) cases_json += ",\n";
+	cases_json += "\t\t{\"name\": ";
+	append_escaped(cases_json, name);
+	cases_json += ", ";
+	cpu.write(cases_json, "cpu_ms");
+	cases_json += ", ";
+	frame_time.write(cases_json, "frame_ms");
+	cases_json += ", ";
+	gpu.write(cases_json, "gpu_ms");
+	cases_json += "}";
+
+	// sorted by `write` now
+	if (!frame_time.ms.empty()) {
+		console::printf(colors::White, "  frame p50 %.3f ms, cpu p50 %.3f ms\n",
+			frame_time.ms[frame_time.ms.size() / 2], cpu.ms[cpu.ms.size() / 2]);
+	}
+}
+
+void Bench_Scene::finish() {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(engine.graphics.physical_device, &properties);
+
+	char temp[256];
+	std::string json = "{\n\t\"engine\": ";
+	append_escaped(json, engine.get_version_string().str());
+	json += ",\n\t\"device\": ";
+	append_escaped(json, properties.deviceName);
+	json += ",\n";
+	json += "\t\"width\": %u,\n\t\"height\": %u,\n\t\"dt\": %.6f,\n\t\"frames\": %u,\n\t\"warmup\": %u,\n"_fmt(temp,
+		engine.graphics.sc_extent.width, engine.graphics.sc_extent.height, engine.fixed_dt, frames, warmup).str();
+	json += "\t\"cases\": [\n" + cases_json + "\n\t]\n}\n";
+
+	if (FILE* file = fopen(out.c_str(), "wb")) {
+		fwrite(json.data(), 1, json.size(), file);
+		fclose(file);
+		console::printf(colors::White, "bench: wrote \"%s\"\n", out.c_str());
+	}
+	else {
+		console::printf(colors::Red, "bench: could not write \"%s\"\n", out.c_str());
+		++failed;
+	}
+
+	if (cases_json.empty()) {
+		console::println(FS_str("bench: no cases ran"), colors::Red);
+		++failed;
+	}
+
+	engine.exit_code = failed ? 1 : 0;
+	engine.flags &=~ engine.fRunning;
+}
+
+void Bench_Scene::on_update(double dt, std::vector<Event> const& events, Render_Context* ctx) {
+	// CPU time and the frame time are from the frame before this one,
+	//  GPU time is from the last frame that was read back
+	s64 now = timestamp();
+	if (scene && frame > warmup) {
+		cpu       .ms.emplace_back(engine.debug_layer.cpu_time * 1000.0f);
+		frame_time.ms.emplace_back((float)seconds_elasped(last, now) * 1000.0f);
+		if (engine.gpu_timer.supported) gpu.ms.emplace_back(engine.gpu_timer.frame_ms);
+	}
+	last = now;
+
+	if (scene && frame == warmup + frames) {
+		end_case();
+		++index;
+	}
+
+	while (!scene) {
+		if (index == std::size(bench_cases)) {
+			if (engine.flags & engine.fRunning) finish();
+			return;
+		}
+		if (!start_case()) ++index;
+	}
+
+	if (auto script = bench_cases[index].script) script(frame, engine.window.event_queue);
+
+	scene->on_update(dt, events, ctx);
+	++frame;
+}
+
+fs::Scene* on_create_scene(fs::Scene_Key const& key) {
+	auto bench = new Bench_Scene;
+	bench->options = key;
+
+	if (!key.name().is_empty() && !(key.name() == "all")) bench->filter = key.name().str();
+
+	for (auto [name, value] : key) {
+		if (name == "frames" && value.type == Scene_Key::Value::Int64)  bench->frames = (u32)max(value.v_s64, (s64)1);
+		if (name == "warmup" && value.type == Scene_Key::Value::Int64)  bench->warmup = (u32)max(value.v_s64, (s64)0);
+		if (name == "dt"     && value.type == Scene_Key::Value::Float64 && value.v_f64 > 0.0) engine.fixed_dt = value.v_f64;
+		if (name == "out"    && value.type == Scene_Key::Value::String) bench->out = value.v_string.str();
+		if (name == "replay" && value.type == Scene_Key::Value::String) bench->replay = true;
+	}
+
+	console::printf(colors::White, "bench: %u frames (+%u warmup), dt %.6f s, %ux%u offscreen\n",
+		bench->frames, bench->warmup, engine.fixed_dt, engine.graphics.sc_extent.width, engine.graphics.sc_extent.height);
+	return bench;
+}
+
+fs::Defaults on_create() {
+	engine.app_name = FS_str("fission-bench");
+	engine.fixed_dt = 1.0 / 60.0;
+	return {
+		.window_title  = FS_str("fission-bench"),
+		.window_width  = 1280,
+		.window_height = 720,
+		.headless      = true,
+	};
+}
@@ -0,0 +1,24 @@
+-- Converts .trace files from profiler.hpp into something a trace viewer can open
+project 'trace_convert'
+    kind 'ConsoleApp'
+    language 'C++'
+    cppdialect "c++20"
+
+    targetdir ("%{wks.location}/bin/" .. output_location)
+	objdir ("%{wks.location}/bin-int/" .. output_location .. "/%{prj.name}")
+
+    files { "%{prj.location}/src/*.cpp" }
+
+	-- profiler.hpp is standalone, no need to link with Fission
+	includedirs '%{FISSION_LOCATION}/include'
+
+    staticruntime "On"
+
+    filter "configurations:Debug"
+        symbols "On"
+
+    filter "configurations:Release"
+        optimize "On"
+
+    filter "configurations:Dist"
+        optimize "Speed"
@@ -0,0 +1,35 @@
+#define PROFILER_IMPLEMENTATION
+#include <Fission/profiler.hpp>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// trace_convert <in.trace> [out]
+//  out ending in .pftrace or .perfetto-trace -> Perfetto protobuf (ui.perfetto.dev)
+//  anything else                             -> Chrome tracing JSON (chrome://tracing)
+static bool ends_with(std::string const& s, char const* suffix) {
+	size_t n = strlen(suffix);
+	return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2 || argc > 3) {
+		fprintf(stderr, "usage: %s <in.trace> [out.json | out.pftrace]\n", argv[0]);
+		return 2;
+	}
+
+	std::string in  = argv[1];
+	std::string out = (argc == 3) ? argv[2] : in + ".json";
+
+	bool perfetto = ends_with(out, ".pftrace") || ends_with(out, ".perfetto-trace");
+
+	auto r = perfetto
+		? profiler::generate_perfetto_from_file(in.c_str(), out.c_str())
+		: profiler::generate_chrome_tracing_from_file(in.c_str(), out.c_str());
+
+	if (r != profiler::result_Success) {
+		fprintf(stderr, "%s: %s\n", in.c_str(), profiler::error_str(r));
+		return 1;
+	}
+	return 0;
+}